@@ -0,0 +1,2453 @@
+// bench.c
+// COIS 3320 Project: benchmark driver for liblfq
+
+#define _GNU_SOURCE // usleep, pthread_condattr_setclock
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sched.h>
+#include <errno.h>
+#include <math.h>
+#include <malloc.h> // malloc_usable_size
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+#endif
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <poll.h>
+
+#include "lfq.h"
+#include "lfq_gen.h"
+#include "harness.h"
+
+// =======================
+// Performance Benchmarking
+// =======================
+
+// -------- Hardware performance counters ----------
+// Each bench thread opens its own counter group with perf_event_open and
+// measures only itself. Counters the kernel, VM or CPU refuses are simply
+// reported as unavailable; the run itself never fails because of them.
+// Context switches fall back to getrusage(RUSAGE_THREAD) when the software
+// event cannot be opened (perf_event_paranoid >= 2).
+enum { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_LLC_MISSES, PERF_HITM, PERF_CTX_SWITCHES, PERF_NUM_COUNTERS };
+
+static const char *perf_counter_names[PERF_NUM_COUNTERS] = {
+    "cycles", "instructions", "llc_misses", "hitm", "ctx_switches"
+};
+
+// Raw PMU event code for HITM loads (model specific, e.g. 0x04d2 on Skylake); 0 = not measured
+static uint64_t perf_hitm_raw = 0;
+
+typedef struct {
+    int fds[PERF_NUM_COUNTERS];   // -1 when the counter could not be opened
+    int leader;
+    long csw_start;               // rusage context switches at start (fallback)
+} PerfGroup;
+
+#ifdef __linux__
+static int perf_open(uint32_t type, uint64_t config, int group_fd, int exclude_kernel) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (group_fd == -1);
+    attr.exclude_kernel = exclude_kernel;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+
+// Opens the counters for the calling thread, disabled until perf_group_start
+static void perf_group_open(PerfGroup *g) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) g->fds[i] = -1;
+    g->leader = -1;
+
+#ifdef __linux__
+    // Context switches are counted in the kernel, so that event cannot exclude it
+    struct { uint32_t type; uint64_t config; int exclude_kernel; } events[PERF_NUM_COUNTERS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 1},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 1},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, 1},
+        {PERF_TYPE_RAW, perf_hitm_raw, 1},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, 0},
+    };
+
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if (i == PERF_HITM && perf_hitm_raw == 0) continue;
+        int fd = perf_open(events[i].type, events[i].config, g->leader, events[i].exclude_kernel);
+        if (fd < 0) continue;
+        g->fds[i] = fd;
+        if (g->leader == -1) g->leader = fd;
+    }
+#endif
+}
+
+static long thread_context_switches(void) {
+#ifdef RUSAGE_THREAD
+    struct rusage ru;
+    if (getrusage(RUSAGE_THREAD, &ru) == 0) return ru.ru_nvcsw + ru.ru_nivcsw;
+#endif
+    return -1;
+}
+
+static void perf_group_start(PerfGroup *g) {
+    g->csw_start = thread_context_switches();
+#ifdef __linux__
+    if (g->leader >= 0) {
+        ioctl(g->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(g->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#else
+    (void)g;
+#endif
+}
+
+// Stops the group, adds the (multiplex-scaled) counts to totals and closes it
+static void perf_group_finish(PerfGroup *g, uint64_t *totals, int *available) {
+#ifdef __linux__
+    if (g->leader >= 0) {
+        ioctl(g->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        uint64_t buf[3]; // value, time enabled, time running
+        if (g->fds[i] < 0) {
+            long csw_end = thread_context_switches();
+            if (i == PERF_CTX_SWITCHES && g->csw_start >= 0 && csw_end >= 0) {
+                totals[i] += (uint64_t)(csw_end - g->csw_start);
+            } else {
+                available[i] = 0;
+            }
+            continue;
+        }
+        if (read(g->fds[i], buf, sizeof(buf)) == sizeof(buf)) {
+            double scale = buf[2] ? (double)buf[1] / buf[2] : 1.0;
+            totals[i] += (uint64_t)(buf[0] * scale);
+        } else {
+            available[i] = 0;
+        }
+        close(g->fds[i]);
+    }
+#else
+    long csw_end = thread_context_switches();
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) available[i] = 0;
+    if (g->csw_start >= 0 && csw_end >= 0) {
+        totals[PERF_CTX_SWITCHES] += (uint64_t)(csw_end - g->csw_start);
+        available[PERF_CTX_SWITCHES] = 1;
+    }
+#endif
+}
+
+// -------- Configurable benchmark driver --------
+// `./lockfree_queue bench [options]` runs any queue under a configurable
+// traffic shape; run_benchmark() below is the default sweep expressed on top
+// of the same driver.
+
+enum { FORMAT_TABLE, FORMAT_CSV, FORMAT_JSON };
+enum { ROLE_MIXED, ROLE_PRODUCER, ROLE_CONSUMER };
+
+#define BENCH_MAX_THREAD_COUNTS 32
+#define BENCH_MAX_QUEUES 10           // Length of bench_queues[], checked below
+#define BENCH_MAX_REPS 64
+#define OPEN_LOOP_START_LOAD 10000.0  // Items/s of the first automatic load step
+#define OPEN_LOOP_MAX_STEPS 24
+#define OPEN_LOOP_SATURATED 0.95      // Delivered/offered below this ends the sweep
+
+typedef struct {
+    const char *queues[BENCH_MAX_QUEUES];
+    int num_queues;
+    int threads[BENCH_MAX_THREAD_COUNTS];
+    int num_thread_counts;
+    int ops;              // Operations per thread, used when duration == 0
+    double duration;      // Seconds per run; overrides ops when > 0
+    double enq_ratio;     // Enqueue share for mixed-role threads
+    int producers;        // Dedicated producer threads in every run
+    int consumers;        // Dedicated consumer threads in every run
+    int fill;             // Items enqueued before timing starts
+    int payload;          // Bytes written before each enqueue / copied after each dequeue
+    int capacity;         // Bounded queue capacity
+    int shard_factor;     // MultiQueue shards per thread
+    int shards;           // MultiQueue shard count (relaxation bound); 0 = shard_factor * threads
+    int latency;          // Record per-operation latency histograms
+    int perf;             // Collect hardware counters per thread
+    int cas_stats;        // Print CAS/retry statistics (needs -DLFQ_STATS)
+    int warmup;           // Discarded runs before measuring each configuration
+    int reps;             // Measured runs per configuration
+    int pin;              // PLACE_* strategy for pinning bench threads
+    const CpuTopology *topology;  // Required when pin != PLACE_NONE
+    const char *save;     // Append results to this result store (JSON lines)
+    int pipeline;         // Dedicated producers/consumers, measure sojourn time
+    int arrival;          // ARRIVAL_* pattern of pipeline producers
+    double rate;          // Items per second per pipeline producer
+    int burst;            // Items per burst for ARRIVAL_BURSTY
+    int service_ns;       // Busy work per item in pipeline consumers
+    int open_loop;        // Pipeline on a precomputed schedule, latency from intended time
+    double loads[BENCH_MAX_THREAD_COUNTS];  // Offered loads (items/s, all producers) to sweep
+    int num_loads;        // 0 with open_loop = double from 10000 items/s until saturation
+    double offered_load;  // Load of the current open-loop run
+    int mem;              // Report memory footprint and allocator telemetry
+    int persist;          // PERSIST_FLUSH or PERSIST_MSYNC for the durable queue
+    int check_lin;        // Record every operation and check the history is linearizable
+    int format;
+} BenchConfig;
+
+// How --check-lin treats a queue's history
+enum {
+    FIFO_NONE,        // Not a strict FIFO; --check-lin refuses it
+    FIFO_STRICT,      // Any violation fails the run
+    FIFO_WEAK_EMPTY,  // Vyukov ring: empty results may be wrong (see bq_dequeue)
+};
+
+// Uniform view of every queue so the driver can swap implementations
+typedef struct {
+    const char *name;
+    void *(*create)(const BenchConfig *cfg, int num_threads);
+    int (*enqueue)(void *q, int value);   // 0 when a bounded queue is full
+    int (*dequeue)(void *q, int *out_value);
+    void (*destroy)(void *q);
+    const char *reclaim;                  // How dequeued nodes are reclaimed
+    int fifo;                             // FIFO_*
+} BenchQueueOps;
+
+typedef struct {
+    const char *queue;
+    int threads;
+    int producers;
+    int consumers;
+    double seconds;
+    long long enqueues;
+    long long dequeues;
+    long long empty_dequeues;
+    long long full_enqueues;
+    int has_latency;
+    uint64_t enq_lat_ns[LAT_NUM_QUANTILES];
+    uint64_t deq_lat_ns[LAT_NUM_QUANTILES];
+    int has_perf;
+    int perf_available[PERF_NUM_COUNTERS];
+    uint64_t perf_totals[PERF_NUM_COUNTERS];   // Summed over all threads
+    int has_cas_stats;
+    LFQStats cas_stats;
+    int pin;              // Placement strategy used for this run
+    int distinct_cpus;    // CPUs the threads were spread over (0 = unpinned)
+    char cpu_list[256];   // "cpu,cpu,..." in thread order, "" when unpinned
+    BenchSummary mops;    // Throughput over all repetitions (n == 1 for a single run)
+    double mops_samples[BENCH_MAX_REPS];     // Per repetition, for the result store
+    double enq_p99_samples[BENCH_MAX_REPS];  // Per repetition, when has_latency
+    double deq_p99_samples[BENCH_MAX_REPS];
+    int pipeline;
+    uint64_t sojourn_ns[LAT_NUM_QUANTILES];  // Enqueue-to-dequeue time, pipeline only
+    int open_loop;
+    double offered_load;  // Items/s the schedule asked for
+    double achieved_load; // Items/s actually delivered
+    int has_mem;
+    const char *reclaim;
+    MemStats mem;         // At the end of the run, queue still alive; counts are per run
+    long long mem_items;  // Items left in the queue at that point
+    long long leaked_allocs;  // Still allocated after destroy + retired-list cleanup
+    int has_lin;
+    LinReport lin;        // First failing repetition's, if any failed
+} BenchResult;
+
+static void *bench_alloc(size_t size) {
+    return xmalloc(size);
+}
+
+static void *bench_lfq_create(const BenchConfig *cfg, int num_threads) {
+    (void)cfg; (void)num_threads;
+    LFQueue *q = bench_alloc(sizeof(LFQueue));
+    lfqueue_init(q);
+    return q;
+}
+static int bench_lfq_enqueue(void *q, int v) { return lfqueue_enqueue(q, v); }
+static int bench_lfq_dequeue(void *q, int *v) { return lfqueue_dequeue(q, v); }
+static void bench_lfq_destroy(void *q) { lfqueue_destroy(q); free(q); }
+
+static void *bench_locked_create(const BenchConfig *cfg, int num_threads) {
+    (void)cfg; (void)num_threads;
+    LockedQueue *q = bench_alloc(sizeof(LockedQueue));
+    lockedqueue_init(q);
+    return q;
+}
+static int bench_locked_enqueue(void *q, int v) { lockedqueue_enqueue(q, v); return 1; }
+static int bench_locked_dequeue(void *q, int *v) { return lockedqueue_dequeue(q, v); }
+static void bench_locked_destroy(void *q) { lockedqueue_destroy(q); free(q); }
+
+static void *bench_mq_create(const BenchConfig *cfg, int num_threads) {
+    MultiQueue *q = bench_alloc(sizeof(MultiQueue));
+    multiqueue_init(q, cfg->shards > 0 ? cfg->shards : cfg->shard_factor * num_threads);
+    return q;
+}
+static int bench_mq_enqueue(void *q, int v) { return multiqueue_enqueue(q, v); }
+static int bench_mq_dequeue(void *q, int *v) { return multiqueue_dequeue(q, v); }
+static void bench_mq_destroy(void *q) { multiqueue_destroy(q); free(q); }
+
+static void *bench_bq_create(const BenchConfig *cfg, int num_threads) {
+    (void)num_threads;
+    BoundedQueue *q = bench_alloc(sizeof(BoundedQueue));
+    bq_init(q, cfg->capacity);
+    return q;
+}
+static int bench_bq_enqueue(void *q, int v) { return bq_try_enqueue(q, v); }
+static int bench_bq_dequeue(void *q, int *v) { return bq_dequeue(q, v); }
+static void bench_bq_destroy(void *q) { bq_destroy(q); free(q); }
+
+static void *bench_stack_create(const BenchConfig *cfg, int num_threads) {
+    (void)cfg; (void)num_threads;
+    LFStack *s = bench_alloc(sizeof(LFStack));
+    lfstack_init(s, 1);
+    return s;
+}
+static int bench_stack_push(void *s, int v) { lfstack_push(s, v); return 1; }
+static int bench_stack_pop(void *s, int *v) { return lfstack_pop(s, v); }
+static void bench_stack_destroy(void *s) { lfstack_destroy(s); free(s); }
+
+static void *bench_pq_create(const BenchConfig *cfg, int num_threads) {
+    (void)cfg; (void)num_threads;
+    LFPriorityQueue *q = bench_alloc(sizeof(LFPriorityQueue));
+    lfpq_init(q);
+    return q;
+}
+static int bench_pq_insert(void *q, int v) { lfpq_insert(q, v, v); return 1; }
+static int bench_pq_delete_min(void *q, int *v) { return lfpq_delete_min(q, NULL, v); }
+static void bench_pq_destroy(void *q) { lfpq_destroy(q); free(q); }
+
+// The region is unlinked as soon as it is mapped, so nothing outlives the run
+static void *bench_shm_create(const BenchConfig *cfg, int num_threads) {
+    (void)num_threads;
+    static _Atomic(int) instance;
+    char name[64];
+    snprintf(name, sizeof(name), "/lfq-bench-%d-%d", (int)getpid(), atomic_fetch_add(&instance, 1));
+    ShmQueue *q = bench_alloc(sizeof(ShmQueue));
+    if (!shmq_open(q, name, (uint32_t)cfg->capacity)) {
+        perror("shm_open");
+        exit(1);
+    }
+    shmq_unlink(name);
+    return q;
+}
+static int bench_shm_enqueue(void *q, int v) { return shmq_enqueue(q, v); }
+static int bench_shm_dequeue(void *q, int *v) { return shmq_dequeue(q, v); }
+static void bench_shm_destroy(void *q) { shmq_close(q); free(q); }
+
+// Backed by a file in /var/tmp, unlinked once mapped
+static void *bench_dq_create(const BenchConfig *cfg, int num_threads) {
+    (void)num_threads;
+    static _Atomic(int) instance;
+    char path[64];
+    snprintf(path, sizeof(path), "/var/tmp/lfq-bench-%d-%d.dat", (int)getpid(), atomic_fetch_add(&instance, 1));
+    DurableQueue *q = bench_alloc(sizeof(DurableQueue));
+    if (!dq_open(q, path, (uint32_t)cfg->capacity, cfg->persist)) {
+        perror(path);
+        exit(1);
+    }
+    unlink(path);
+    return q;
+}
+static int bench_dq_enqueue(void *q, int v) { return dq_enqueue(q, v); }
+static int bench_dq_dequeue(void *q, int *v) { return dq_dequeue(q, v); }
+static void bench_dq_destroy(void *q) { dq_close(q); free(q); }
+
+// Specialized instantiations (lfq_gen.h). Mixed threads both enqueue and
+// dequeue, so the driver can only offer the MPMC ones.
+LFQ_DEFINE(bench_gen_mpmc, int, MPMC, UNBOUNDED, RETIRE)
+LFQ_DEFINE(bench_gen_ring, int, MPMC, BOUNDED, NONE)
+
+static void *bench_gen_mpmc_create(const BenchConfig *cfg, int num_threads) {
+    (void)cfg; (void)num_threads;
+    bench_gen_mpmc *q = bench_alloc(sizeof(bench_gen_mpmc));
+    bench_gen_mpmc_init(q, 0);
+    return q;
+}
+static int bench_gen_mpmc_enq(void *q, int v) { return bench_gen_mpmc_enqueue(q, v); }
+static int bench_gen_mpmc_deq(void *q, int *v) { return bench_gen_mpmc_dequeue(q, v); }
+static void bench_gen_mpmc_free(void *q) { bench_gen_mpmc_destroy(q); free(q); }
+
+static void *bench_gen_ring_create(const BenchConfig *cfg, int num_threads) {
+    (void)num_threads;
+    bench_gen_ring *q = bench_alloc(sizeof(bench_gen_ring));
+    bench_gen_ring_init(q, cfg->capacity);
+    return q;
+}
+static int bench_gen_ring_enq(void *q, int v) { return bench_gen_ring_enqueue(q, v); }
+static int bench_gen_ring_deq(void *q, int *v) { return bench_gen_ring_dequeue(q, v); }
+static void bench_gen_ring_free(void *q) { bench_gen_ring_destroy(q); free(q); }
+
+static const BenchQueueOps bench_queues[] = {
+    {"lfq", bench_lfq_create, bench_lfq_enqueue, bench_lfq_dequeue, bench_lfq_destroy, "retired-list",
+     FIFO_STRICT},
+    {"locked", bench_locked_create, bench_locked_enqueue, bench_locked_dequeue, bench_locked_destroy,
+     "immediate", FIFO_STRICT},
+    // Relaxed FIFO: reorders by design, so the rank-error benchmark measures it instead
+    {"multiqueue", bench_mq_create, bench_mq_enqueue, bench_mq_dequeue, bench_mq_destroy, "retired-list",
+     FIFO_NONE},
+    {"bounded", bench_bq_create, bench_bq_enqueue, bench_bq_dequeue, bench_bq_destroy, "preallocated",
+     FIFO_WEAK_EMPTY},
+    {"shm", bench_shm_create, bench_shm_enqueue, bench_shm_dequeue, bench_shm_destroy, "preallocated",
+     FIFO_STRICT},
+    {"durable", bench_dq_create, bench_dq_enqueue, bench_dq_dequeue, bench_dq_destroy, "preallocated",
+     FIFO_STRICT},
+    {"stack", bench_stack_create, bench_stack_push, bench_stack_pop, bench_stack_destroy, "retired-list",
+     FIFO_NONE},
+    {"pq", bench_pq_create, bench_pq_insert, bench_pq_delete_min, bench_pq_destroy, "retired-list", FIFO_NONE},
+    {"gen-mpmc", bench_gen_mpmc_create, bench_gen_mpmc_enq, bench_gen_mpmc_deq, bench_gen_mpmc_free,
+     "retired-list", FIFO_STRICT},
+    {"gen-bounded", bench_gen_ring_create, bench_gen_ring_enq, bench_gen_ring_deq, bench_gen_ring_free,
+     "preallocated", FIFO_WEAK_EMPTY},
+};
+#define NUM_BENCH_QUEUES ((int)(sizeof(bench_queues) / sizeof(bench_queues[0])))
+_Static_assert(NUM_BENCH_QUEUES == BENCH_MAX_QUEUES, "BENCH_MAX_QUEUES must match bench_queues[]");
+
+static const BenchQueueOps *bench_find_queue(const char *name) {
+    for (int i = 0; i < NUM_BENCH_QUEUES; i++) {
+        if (strcmp(bench_queues[i].name, name) == 0) return &bench_queues[i];
+    }
+    return NULL;
+}
+
+// Whether a --check-lin verdict fails the run. A ring's empty results are
+// weaker than linearizable, and LIN_EMPTY implies every other pattern passed.
+static int bench_lin_failed(const BenchQueueOps *ops, const LinReport *l) {
+    if (l->violation == LIN_EMPTY && ops->fifo == FIFO_WEAK_EMPTY) return 0;
+    return l->violation != LIN_OK;
+}
+
+void bench_config_defaults(BenchConfig *cfg) {
+    static const int default_threads[] = {1, 2, 4, 8, 16, 32};
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->queues[0] = "lfq";
+    cfg->queues[1] = "locked";
+    cfg->num_queues = 2;
+    for (int i = 0; i < 6; i++) {
+        cfg->threads[i] = default_threads[i];
+    }
+    cfg->num_thread_counts = 6;
+    cfg->ops = 50000;
+    cfg->enq_ratio = 0.5;
+    cfg->fill = 100;
+    cfg->capacity = 1024;
+    cfg->shard_factor = 4;
+    cfg->warmup = 0;
+    cfg->reps = 1;
+    cfg->rate = 100000;
+    cfg->burst = 64;
+    cfg->persist = PERSIST_FLUSH;
+    cfg->format = FORMAT_TABLE;
+}
+
+typedef struct {
+    const BenchConfig *cfg;
+    const BenchQueueOps *ops;
+    void *q;
+    int id;
+    int role;
+    int cpu;                 // CPU to pin to, -1 to leave placement to the OS
+    _Atomic(int) *stop;
+    _Atomic(int) *go;
+    pthread_barrier_t *start;
+    unsigned char *payload;  // 2 * cfg->payload bytes: item being written, item read back
+    LatencyHist *enq_hist;   // Per-thread, merged after the run (cfg->latency only)
+    LatencyHist *deq_hist;
+    struct BenchPipeline *pipe;  // Shared pipeline state (cfg->pipeline only)
+    LatencyHist *sojourn_hist;
+    uint64_t *schedule;          // Intended send offsets (cfg->open_loop producers)
+    long long items;             // Items this producer offers
+    PerfGroup perf;
+    uint64_t perf_totals[PERF_NUM_COUNTERS];
+    int perf_available[PERF_NUM_COUNTERS];
+    long long enqueues;
+    long long dequeues;
+    long long empty_dequeues;
+    long long full_enqueues;
+    LinLog lin;                  // History of this thread's operations (cfg->check_lin only)
+} BenchThread;
+
+// Pipeline mode: item values index stamps[], where the producer records when
+// it offered the item (values are producer * ops + sequence, so the queues
+// keep carrying plain ints). The enqueue publishes the stamp to whichever
+// consumer dequeues the item.
+//
+// In open-loop mode the stamp is the intended send time from a precomputed
+// schedule rather than the moment of the enqueue, so a producer that falls
+// behind (because the queue is slow) is charged for it instead of silently
+// sending less: this is what avoids coordinated omission.
+typedef struct BenchPipeline {
+    uint64_t *stamps;
+    int producers;
+    double rate;          // Items/s per producer
+    _Atomic(uint64_t) start_ns;  // clock_ns() when the run started
+    _Atomic(int) producers_done;
+} BenchPipeline;
+
+static void bench_pipeline_produce(BenchThread *t) {
+    const BenchConfig *cfg = t->cfg;
+    uint64_t start = atomic_load(&t->pipe->start_ns);
+    uint64_t next = clock_ns();
+    unsigned seed = t->id + 1;
+
+    for (long long seq = 0; seq < t->items; seq++) {
+        if ((seq & 63) == 0 && atomic_load(t->stop)) break;
+        if (cfg->open_loop) next = start + t->schedule[seq];
+        else next += arrival_gap_ns(cfg->arrival, seq, t->pipe->rate, cfg->burst, &seed);
+        if (cfg->arrival != ARRIVAL_OVERLOAD) wait_until_ns(next);
+
+        int value = (int)(t->id * (long long)cfg->ops + seq);
+        if (cfg->payload) memset(t->payload, (int)seq, cfg->payload);
+        // Open loop: the clock started at the intended send time (lat_now is
+        // clock_ns here, --timer rdtsc is rejected in this mode)
+        uint64_t t0 = cfg->open_loop ? next : lat_now();
+        t->pipe->stamps[value] = t0;
+        // A full bounded queue pushes back: the wait counts toward sojourn time
+        while (!t->ops->enqueue(t->q, value)) {
+            t->full_enqueues++;
+            sched_yield();
+        }
+        t->enqueues++;
+        if (cfg->latency) hist_record(t->enq_hist, lat_now() - t0);
+    }
+    atomic_fetch_add(&t->pipe->producers_done, 1);
+}
+
+static void bench_pipeline_consume(BenchThread *t) {
+    const BenchConfig *cfg = t->cfg;
+
+    while (true) {
+        // Once every producer has finished, an empty queue stays empty
+        int done = atomic_load(&t->pipe->producers_done) == t->pipe->producers;
+        int value;
+        uint64_t t0 = lat_now();
+        if (t->ops->dequeue(t->q, &value)) {
+            uint64_t now = lat_now();
+            uint64_t stamp = t->pipe->stamps[value];
+            hist_record(t->sojourn_hist, now > stamp ? now - stamp : 0);
+            if (cfg->latency) hist_record(t->deq_hist, now - t0);
+            if (cfg->payload) memcpy(t->payload + cfg->payload, t->payload, cfg->payload);
+            t->dequeues++;
+            if (cfg->service_ns) {
+                uint64_t end = clock_ns() + cfg->service_ns;
+                while (clock_ns() < end) {
+                }
+            }
+        } else {
+            if (done) break;
+            t->empty_dequeues++;
+            sched_yield();
+        }
+    }
+}
+
+static void *bench_thread(void *arg) {
+    BenchThread *t = (BenchThread *)arg;
+    const BenchConfig *cfg = t->cfg;
+    unsigned int seed = t->id;
+    double threshold = cfg->enq_ratio * ((double)RAND_MAX + 1.0);
+    int timed = cfg->duration > 0;
+
+    if (t->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(t->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    if (cfg->perf) perf_group_open(&t->perf);
+
+    // All threads check in, then wait for the clock to start
+    pthread_barrier_wait(t->start);
+    while (!atomic_load(t->go)) sched_yield();
+    if (cfg->perf) perf_group_start(&t->perf);
+
+    if (cfg->pipeline) {
+        if (t->role == ROLE_PRODUCER) bench_pipeline_produce(t);
+        else bench_pipeline_consume(t);
+        timed = 0;
+    }
+    for (long long i = 0; !cfg->pipeline && (timed || i < cfg->ops); i++) {
+        if (timed && (i & 63) == 0 && atomic_load(t->stop)) break;
+
+        int enq = t->role == ROLE_PRODUCER ||
+                  (t->role == ROLE_MIXED && rand_r(&seed) < threshold);
+        uint64_t t0 = cfg->latency ? lat_now() : 0;
+        uint64_t lin_t0 = cfg->check_lin ? clock_ns() : 0;
+        if (enq) {
+            // A history needs unique values; --check-lin implies a fixed --ops
+            int value = cfg->check_lin ? t->id * cfg->ops + (int)i : (int)i;
+            if (cfg->payload) memset(t->payload, (int)i, cfg->payload);
+            int ok = t->ops->enqueue(t->q, value);
+            if (ok) t->enqueues++;
+            else t->full_enqueues++;
+            if (cfg->latency) hist_record(t->enq_hist, lat_now() - t0);
+            if (cfg->check_lin) lin_record(&t->lin, LIN_ENQ, value, ok, lin_t0, clock_ns());
+        } else {
+            int val = 0;
+            int ok = t->ops->dequeue(t->q, &val);
+            if (ok) {
+                if (cfg->payload) memcpy(t->payload + cfg->payload, t->payload, cfg->payload);
+                t->dequeues++;
+            } else {
+                t->empty_dequeues++;
+            }
+            if (cfg->latency) hist_record(t->deq_hist, lat_now() - t0);
+            if (cfg->check_lin) lin_record(&t->lin, LIN_DEQ, val, ok, lin_t0, clock_ns());
+        }
+    }
+
+    if (cfg->perf) {
+        for (int i = 0; i < PERF_NUM_COUNTERS; i++) t->perf_available[i] = 1;
+        perf_group_finish(&t->perf, t->perf_totals, t->perf_available);
+    }
+    return NULL;
+}
+
+// Runs one configuration. The first cfg->producers threads only enqueue, the
+// next cfg->consumers only dequeue and the rest mix by cfg->enq_ratio.
+int bench_run_once(const BenchConfig *cfg, const BenchQueueOps *ops,
+                   int num_threads, BenchResult *result) {
+    int producers = cfg->producers, consumers = cfg->consumers;
+    if (cfg->pipeline) {
+        // Every thread is a producer or a consumer; split evenly unless told
+        if (producers == 0) producers = num_threads / 2 > 0 ? num_threads / 2 : 1;
+        consumers = num_threads - producers;
+        if (consumers < 1 || (long long)producers * cfg->ops > INT_MAX) return -1;
+    }
+    if (producers + consumers > num_threads) return -1;
+
+    pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+    BenchThread *args = calloc(num_threads, sizeof(BenchThread));
+    int *cpus = malloc(num_threads * sizeof(int));
+    int distinct_cpus = placement_plan(cfg->topology, cfg->pin, num_threads, cpus);
+    pthread_barrier_t start_barrier;
+    _Atomic(int) stop = 0;
+    _Atomic(int) go = 0;
+    BenchPipeline pipe;
+
+    // One history per thread plus one for the pre-fill
+    LinLog *lin_logs = NULL;
+    if (cfg->check_lin) {
+        lin_logs = xmalloc((num_threads + 1) * sizeof(LinLog));
+        for (int i = 0; i <= num_threads; i++) {
+            lin_log_init(&lin_logs[i], i < num_threads ? (size_t)cfg->ops : (size_t)cfg->fill);
+        }
+    }
+
+    MemStats mem_base, mem_start, mem_end;
+    retired_list_init();
+    mem_stats_reset();
+    mem_stats_snapshot(&mem_base);
+    void *q = ops->create(cfg, num_threads);
+    if (cfg->pipeline) {
+        // No pre-fill: every value in the queue must index a stamp
+        pipe.stamps = bench_alloc((size_t)producers * cfg->ops * sizeof(uint64_t));
+        pipe.producers = producers;
+        pipe.rate = cfg->open_loop ? cfg->offered_load / producers : cfg->rate;
+        atomic_init(&pipe.start_ns, 0);
+        atomic_init(&pipe.producers_done, 0);
+    } else {
+        // Pre-filled items get negative values so they never collide with
+        // the threads' values in a --check-lin history
+        LinLog *fill_log = cfg->check_lin ? &lin_logs[num_threads] : NULL;
+        for (int i = 0; i < cfg->fill; i++) {
+            int value = cfg->check_lin ? -1 - i : i;
+            uint64_t t0 = cfg->check_lin ? clock_ns() : 0;
+            int ok = ops->enqueue(q, value);
+            if (cfg->check_lin) lin_record(fill_log, LIN_ENQ, value, ok, t0, clock_ns());
+        }
+    }
+
+    pthread_barrier_init(&start_barrier, NULL, num_threads + 1);
+    for (int i = 0; i < num_threads; i++) {
+        args[i].cfg = cfg;
+        args[i].ops = ops;
+        args[i].q = q;
+        args[i].id = i;
+        args[i].role = i < producers ? ROLE_PRODUCER
+                     : i < producers + consumers ? ROLE_CONSUMER
+                     : ROLE_MIXED;
+        args[i].cpu = cpus[i];
+        args[i].stop = &stop;
+        args[i].go = &go;
+        args[i].start = &start_barrier;
+        args[i].payload = cfg->payload ? bench_alloc(2 * (size_t)cfg->payload) : NULL;
+        if (cfg->check_lin) args[i].lin = lin_logs[i];
+        if (cfg->latency) {
+            args[i].enq_hist = calloc(1, sizeof(LatencyHist));
+            args[i].deq_hist = calloc(1, sizeof(LatencyHist));
+        }
+        if (cfg->pipeline) {
+            args[i].pipe = &pipe;
+            args[i].sojourn_hist = calloc(1, sizeof(LatencyHist));
+            args[i].items = cfg->ops;
+            if (cfg->open_loop && cfg->duration > 0 && cfg->duration * pipe.rate < cfg->ops) {
+                args[i].items = (long long)(cfg->duration * pipe.rate) + 1;
+            }
+            if (cfg->open_loop && args[i].role == ROLE_PRODUCER) {
+                args[i].schedule = arrival_schedule(cfg->arrival, args[i].items, pipe.rate,
+                                                    cfg->burst, (unsigned)i + 1);
+            }
+        }
+        pthread_create(&threads[i], NULL, bench_thread, &args[i]);
+    }
+
+    struct timespec start, end;
+    pthread_barrier_wait(&start_barrier);
+    if (cfg->cas_stats) lfq_stats_reset();
+    mem_stats_snapshot(&mem_start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (cfg->pipeline) atomic_store(&pipe.start_ns, clock_ns());
+    atomic_store(&go, 1);
+
+    if (cfg->duration > 0) {
+        struct timespec nap;
+        nap.tv_sec = (time_t)cfg->duration;
+        nap.tv_nsec = (long)((cfg->duration - nap.tv_sec) * 1e9);
+        if (cfg->pipeline) {
+            // Producers may run out of items (--ops) before the deadline
+            uint64_t deadline = clock_ns() + (uint64_t)(cfg->duration * 1e9);
+            struct timespec tick = {0, 1000000};
+            while (clock_ns() < deadline && atomic_load(&pipe.producers_done) < producers) {
+                nanosleep(&tick, NULL);
+            }
+        } else {
+            nanosleep(&nap, NULL);
+        }
+        atomic_store(&stop, 1);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    mem_stats_snapshot(&mem_end);
+
+    memset(result, 0, sizeof(*result));
+    if (cfg->check_lin) {
+        // Checked after the clock stopped, so it does not count against throughput
+        for (int i = 0; i < num_threads; i++) lin_logs[i] = args[i].lin;
+        result->has_lin = 1;
+        lin_check_fifo(lin_logs, num_threads + 1, &result->lin);
+        for (int i = 0; i <= num_threads; i++) lin_log_free(&lin_logs[i]);
+        free(lin_logs);
+    }
+    if (cfg->cas_stats) {
+        result->has_cas_stats = 1;
+        lfq_stats_snapshot(&result->cas_stats);
+    }
+    result->queue = ops->name;
+    result->threads = num_threads;
+    result->producers = producers;
+    result->consumers = consumers;
+    result->pipeline = cfg->pipeline;
+    result->open_loop = cfg->open_loop;
+    result->offered_load = cfg->open_loop ? cfg->offered_load : 0.0;
+    result->seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    result->pin = cfg->pin;
+    result->distinct_cpus = distinct_cpus;
+    for (int i = 0, len = 0; distinct_cpus && i < num_threads; i++) {
+        int w = snprintf(result->cpu_list + len, sizeof(result->cpu_list) - len,
+                         "%s%d", i ? "," : "", cpus[i]);
+        if (w < 0 || len + w >= (int)sizeof(result->cpu_list)) {
+            result->cpu_list[len] = '\0'; // Drop the partial entry
+            break;
+        }
+        len += w;
+    }
+    LatencyHist *enq_hist = cfg->latency ? calloc(1, sizeof(LatencyHist)) : NULL;
+    LatencyHist *deq_hist = cfg->latency ? calloc(1, sizeof(LatencyHist)) : NULL;
+    LatencyHist *sojourn_hist = cfg->pipeline ? calloc(1, sizeof(LatencyHist)) : NULL;
+    for (int i = 0; i < num_threads; i++) {
+        result->enqueues += args[i].enqueues;
+        result->dequeues += args[i].dequeues;
+        result->empty_dequeues += args[i].empty_dequeues;
+        result->full_enqueues += args[i].full_enqueues;
+        if (cfg->latency) {
+            hist_merge(enq_hist, args[i].enq_hist);
+            hist_merge(deq_hist, args[i].deq_hist);
+            free(args[i].enq_hist);
+            free(args[i].deq_hist);
+        }
+        if (cfg->pipeline) {
+            hist_merge(sojourn_hist, args[i].sojourn_hist);
+            free(args[i].sojourn_hist);
+            free(args[i].schedule);
+        }
+        free(args[i].payload);
+    }
+    result->achieved_load = result->dequeues / result->seconds;
+    if (cfg->pipeline) {
+        for (int k = 0; k < LAT_NUM_QUANTILES; k++) {
+            result->sojourn_ns[k] = lat_to_ns(hist_quantile(sojourn_hist, lat_quantiles[k]));
+        }
+        free(sojourn_hist);
+        free(pipe.stamps);
+    }
+    if (cfg->perf) {
+        result->has_perf = 1;
+        for (int k = 0; k < PERF_NUM_COUNTERS; k++) {
+            result->perf_available[k] = 1;
+            for (int i = 0; i < num_threads; i++) {
+                result->perf_totals[k] += args[i].perf_totals[k];
+                result->perf_available[k] &= args[i].perf_available[k];
+            }
+        }
+    }
+    if (cfg->latency) {
+        result->has_latency = 1;
+        for (int k = 0; k < LAT_NUM_QUANTILES; k++) {
+            result->enq_lat_ns[k] = lat_to_ns(hist_quantile(enq_hist, lat_quantiles[k]));
+            result->deq_lat_ns[k] = lat_to_ns(hist_quantile(deq_hist, lat_quantiles[k]));
+        }
+        free(enq_hist);
+        free(deq_hist);
+    }
+
+    ops->destroy(q);
+    retired_list_cleanup();
+    if (cfg->mem) {
+        // Allocator calls during the timed run; footprint relative to before create()
+        MemStats after;
+        mem_stats_snapshot(&after);
+        result->has_mem = 1;
+        result->reclaim = ops->reclaim;
+        result->mem = mem_end;
+        result->mem.alloc_calls -= mem_start.alloc_calls;
+        result->mem.free_calls -= mem_start.free_calls;
+        result->mem.live_allocs -= mem_base.live_allocs;
+        result->mem.live_bytes -= mem_base.live_bytes;
+        result->mem_items = (cfg->pipeline ? 0 : cfg->fill) + result->enqueues - result->dequeues;
+        result->leaked_allocs = after.live_allocs - mem_base.live_allocs;
+    }
+    pthread_barrier_destroy(&start_barrier);
+    free(threads);
+    free(args);
+    free(cpus);
+    return 0;
+}
+
+// Pipeline threads spin on empty/full queues, so only delivered items count there
+static long long bench_total_ops(const BenchResult *r) {
+    if (r->pipeline) return r->enqueues + r->dequeues;
+    return r->enqueues + r->dequeues + r->empty_dequeues + r->full_enqueues;
+}
+
+static double bench_mops(const BenchResult *r) {
+    return bench_total_ops(r) / r->seconds / 1e6;
+}
+
+// Runs cfg->warmup discarded iterations, then cfg->reps measured ones. The
+// result is the repetition with the median throughput (so latency and
+// counters come from a representative run) plus a summary over all of them.
+int bench_run_repeated(const BenchConfig *cfg, const BenchQueueOps *ops,
+                       int num_threads, BenchResult *result) {
+    BenchResult *runs = xmalloc(cfg->reps * sizeof(BenchResult));
+    double *mops = xmalloc(cfg->reps * sizeof(double));
+    memset(runs, 0, cfg->reps * sizeof(BenchResult));
+    int rc = 0;
+
+    for (int i = 0; i < cfg->warmup && rc == 0; i++) {
+        rc = bench_run_once(cfg, ops, num_threads, &runs[0]);
+    }
+    for (int i = 0; i < cfg->reps && rc == 0; i++) {
+        rc = bench_run_once(cfg, ops, num_threads, &runs[i]);
+        mops[i] = bench_mops(&runs[i]);
+    }
+    if (rc == 0) {
+        BenchSummary summary;
+        bench_summarize(mops, cfg->reps, &summary);
+        int median = 0;
+        for (int i = 1; i < cfg->reps; i++) {
+            if (fabs(mops[i] - summary.median) < fabs(mops[median] - summary.median)) median = i;
+        }
+        *result = runs[median];
+        result->mops = summary;
+        // First failing repetition, else the first with any verdict to show
+        for (int i = 0; i < cfg->reps; i++) {
+            if (!runs[i].has_lin || runs[i].lin.violation == LIN_OK) continue;
+            int failed = bench_lin_failed(ops, &runs[i].lin);
+            if (failed || result->lin.violation == LIN_OK) result->lin = runs[i].lin;
+            if (failed) break;
+        }
+        for (int i = 0; i < cfg->reps; i++) {
+            result->mops_samples[i] = mops[i];
+            result->enq_p99_samples[i] = (double)runs[i].enq_lat_ns[LAT_P99];
+            result->deq_p99_samples[i] = (double)runs[i].deq_lat_ns[LAT_P99];
+        }
+    }
+
+    free(runs);
+    free(mops);
+    return rc;
+}
+
+static void bench_print_header(const BenchConfig *cfg) {
+    if (cfg->format == FORMAT_CSV) {
+        printf("queue,threads,producers,consumers,placement,cpus,seconds,ops,mops_per_sec,"
+               "enqueues,dequeues,empty_dequeues,full_enqueues");
+        if (cfg->latency) {
+            for (int op = 0; op < 2; op++) {
+                for (int k = 0; k < LAT_NUM_QUANTILES; k++) {
+                    printf(",%s_%s_ns", op == 0 ? "enq" : "deq", lat_quantile_names[k]);
+                }
+            }
+        }
+        if (cfg->perf) {
+            for (int k = 0; k < PERF_NUM_COUNTERS; k++) {
+                printf(",%s_per_op", perf_counter_names[k]);
+            }
+        }
+        if (cfg->reps > 1) {
+            printf(",reps,mops_median,mops_mean,mops_stddev,mops_ci95_lo,mops_ci95_hi,outliers");
+        }
+        if (cfg->pipeline) {
+            for (int k = 0; k < LAT_NUM_QUANTILES; k++) {
+                printf(",sojourn_%s_ns", lat_quantile_names[k]);
+            }
+        }
+        if (cfg->open_loop) printf(",offered_load,achieved_load");
+        if (cfg->mem) {
+            printf(",reclaim,allocator_calls_per_op,live_allocs,live_bytes,bytes_per_item,"
+                   "peak_retired,dropped,leaked_allocs,rss_kb,peak_rss_kb");
+        }
+        if (cfg->check_lin) printf(",history,history_value,history_other");
+        printf("\n");
+    } else if (cfg->format == FORMAT_JSON) {
+        printf("[\n");
+    } else {
+        printf("%-11s | %-7s | %-5s | %-5s | %-10s | %-10s | %-10s | %-10s\n",
+               "Queue", "Threads", "Prod", "Cons", "Time (s)", "Mops/s", "Empty deq", "Full enq");
+        printf("-------------------------------------------------------------------------------------------\n");
+    }
+}
+
+// Prints one set of quantiles (ns) in the current format
+static void bench_print_quantiles(const BenchConfig *cfg, const char *json_key, const char *label,
+                                  const uint64_t *ns) {
+    if (cfg->format == FORMAT_CSV) {
+        for (int k = 0; k < LAT_NUM_QUANTILES; k++) {
+            printf(",%llu", (unsigned long long)ns[k]);
+        }
+    } else if (cfg->format == FORMAT_JSON) {
+        printf(", \"%s\": {", json_key);
+        for (int k = 0; k < LAT_NUM_QUANTILES; k++) {
+            printf("%s\"%s\": %llu", k ? ", " : "", lat_quantile_names[k], (unsigned long long)ns[k]);
+        }
+        printf("}");
+    } else {
+        printf("    %s (ns):", label);
+        for (int k = 0; k < LAT_NUM_QUANTILES; k++) {
+            printf(" %s=%llu", lat_quantile_names[k], (unsigned long long)ns[k]);
+        }
+        printf("\n");
+    }
+}
+
+// Prints one latency row per operation type in the current format
+static void bench_print_latency(const BenchConfig *cfg, const BenchResult *r) {
+    bench_print_quantiles(cfg, "enq_latency_ns", "enq latency", r->enq_lat_ns);
+    bench_print_quantiles(cfg, "deq_latency_ns", "deq latency", r->deq_lat_ns);
+}
+
+// Prints the throughput summary of a multi-repetition run
+static void bench_print_summary(const BenchConfig *cfg, const BenchResult *r) {
+    const BenchSummary *s = &r->mops;
+    if (cfg->format == FORMAT_CSV) {
+        printf(",%d,%.4f,%.4f,%.4f,%.4f,%.4f,%d", s->n, s->median, s->mean, s->stddev,
+               s->ci95_lo, s->ci95_hi, s->outliers);
+    } else if (cfg->format == FORMAT_JSON) {
+        printf(", \"mops\": {\"reps\": %d, \"median\": %.4f, \"mean\": %.4f, \"stddev\": %.4f, "
+               "\"ci95\": [%.4f, %.4f], \"outliers\": %d}",
+               s->n, s->median, s->mean, s->stddev, s->ci95_lo, s->ci95_hi, s->outliers);
+    } else {
+        printf("    Mops/s over %d reps: median=%.2f mean=%.2f stddev=%.2f 95%% CI=[%.2f, %.2f] outliers=%d\n",
+               s->n, s->median, s->mean, s->stddev, s->ci95_lo, s->ci95_hi, s->outliers);
+    }
+}
+
+// Prints the memory footprint at the end of a run and allocator calls per op
+static void bench_print_mem(const BenchConfig *cfg, const BenchResult *r) {
+    const MemStats *m = &r->mem;
+    long long ops = bench_total_ops(r);
+    double calls_per_op = ops ? (double)(m->alloc_calls + m->free_calls) / ops : 0.0;
+    double per_item = r->mem_items > 0 ? (double)m->live_bytes / r->mem_items : 0.0;
+
+    if (cfg->format == FORMAT_CSV) {
+        printf(",%s,%.4f,%lld,%lld,%.1f,%d,%lld,%lld,%ld,%ld", r->reclaim, calls_per_op,
+               m->live_allocs, m->live_bytes, per_item, m->peak_retired, m->dropped,
+               r->leaked_allocs, m->rss_kb, m->peak_rss_kb);
+    } else if (cfg->format == FORMAT_JSON) {
+        printf(", \"memory\": {\"reclaim\": \"%s\", \"allocator_calls_per_op\": %.4f, "
+               "\"live_allocs\": %lld, \"live_bytes\": %lld, \"bytes_per_item\": %.1f, "
+               "\"peak_retired\": %d, \"dropped\": %lld, \"leaked_allocs\": %lld, "
+               "\"rss_kb\": %ld, \"peak_rss_kb\": %ld}",
+               r->reclaim, calls_per_op, m->live_allocs, m->live_bytes, per_item, m->peak_retired,
+               m->dropped, r->leaked_allocs, m->rss_kb, m->peak_rss_kb);
+    } else {
+        printf("    memory (%s): %.3f allocator calls/op, %lld live allocs, %.1f KiB, "
+               "%.1f B/item over %lld items\n", r->reclaim, calls_per_op, m->live_allocs,
+               m->live_bytes / 1024.0, per_item, r->mem_items);
+        printf("    retired: peak %d of %d, %lld dropped, %lld allocs leaked after destroy; "
+               "RSS %ld KiB (peak %ld KiB)\n", m->peak_retired, MAX_RETIRED, m->dropped,
+               r->leaked_allocs, m->rss_kb, m->peak_rss_kb);
+    }
+}
+
+// Prints the --check-lin verdict: "linearizable" or the violation pattern and
+// its values. An empty violation a ring is allowed is labelled, not failed.
+static void bench_print_lin(const BenchConfig *cfg, const BenchResult *r) {
+    const LinReport *l = &r->lin;
+    int weak_empty = l->violation == LIN_EMPTY && bench_find_queue(r->queue)->fifo == FIFO_WEAK_EMPTY;
+    const char *verdict = weak_empty ? "not linearizable on empty" : lin_violation_names[l->violation];
+    if (cfg->format == FORMAT_CSV) {
+        printf(",%s,%d,%d", verdict, l->value, l->other);
+    } else if (cfg->format == FORMAT_JSON) {
+        printf(", \"history\": {\"verdict\": \"%s\", \"value\": %d, \"other\": %d}",
+               verdict, l->value, l->other);
+    } else if (l->violation == LIN_OK) {
+        printf("    history: linearizable (%zu enqueues, %zu dequeues, %zu empty)\n",
+               l->enqueues, l->dequeues, l->empty_dequeues);
+    } else if (weak_empty) {
+        printf("    history: not linearizable on empty: a dequeue found none while %d was queued"
+               " (allowed for this ring)\n", l->value);
+    } else if (l->violation == LIN_ORDER) {
+        printf("    history: NOT linearizable: %d dequeued while %d, enqueued earlier, was not\n",
+               l->value, l->other);
+    } else {
+        printf("    history: NOT linearizable: %s violation on value %d\n", verdict, l->value);
+    }
+}
+
+// Prints counters normalised per operation; unavailable ones are n/a, empty or null
+static void bench_print_perf(const BenchConfig *cfg, const BenchResult *r) {
+    long long ops = bench_total_ops(r);
+
+    if (cfg->format == FORMAT_JSON) printf(", \"perf_per_op\": {");
+    else if (cfg->format == FORMAT_TABLE) printf("    perf per op:");
+
+    for (int k = 0; k < PERF_NUM_COUNTERS; k++) {
+        double per_op = ops ? (double)r->perf_totals[k] / ops : 0.0;
+        int ok = r->perf_available[k];
+
+        if (cfg->format == FORMAT_CSV) {
+            if (ok) printf(",%.4g", per_op);
+            else printf(",");
+        } else if (cfg->format == FORMAT_JSON) {
+            printf("%s\"%s\": ", k ? ", " : "", perf_counter_names[k]);
+            if (ok) printf("%.4g", per_op);
+            else printf("null");
+        } else {
+            if (ok) printf(" %s=%.4g", perf_counter_names[k], per_op);
+            else printf(" %s=n/a", perf_counter_names[k]);
+        }
+    }
+
+    if (cfg->format == FORMAT_JSON) printf("}");
+    else if (cfg->format == FORMAT_TABLE) printf("\n");
+}
+
+static void bench_print_result(const BenchConfig *cfg, const BenchResult *r, int first) {
+    long long ops = bench_total_ops(r);
+    double mops = ops / r->seconds / 1e6;
+
+    if (cfg->format == FORMAT_CSV) {
+        printf("%s,%d,%d,%d,%s,\"%s\",%.6f,%lld,%.4f,%lld,%lld,%lld,%lld",
+               r->queue, r->threads, r->producers, r->consumers, placement_names[r->pin],
+               r->cpu_list, r->seconds, ops, mops,
+               r->enqueues, r->dequeues, r->empty_dequeues, r->full_enqueues);
+        if (r->has_latency) bench_print_latency(cfg, r);
+        if (r->has_perf) bench_print_perf(cfg, r);
+        if (cfg->reps > 1) bench_print_summary(cfg, r);
+        if (r->pipeline) bench_print_quantiles(cfg, "sojourn_ns", "sojourn", r->sojourn_ns);
+        if (r->open_loop) printf(",%.0f,%.0f", r->offered_load, r->achieved_load);
+        if (r->has_mem) bench_print_mem(cfg, r);
+        if (r->has_lin) bench_print_lin(cfg, r);
+        printf("\n");
+    } else if (cfg->format == FORMAT_JSON) {
+        printf("%s  {\"queue\": \"%s\", \"threads\": %d, \"producers\": %d, \"consumers\": %d, "
+               "\"placement\": \"%s\", \"cpus\": [%s], "
+               "\"seconds\": %.6f, \"ops\": %lld, \"mops_per_sec\": %.4f, \"enqueues\": %lld, "
+               "\"dequeues\": %lld, \"empty_dequeues\": %lld, \"full_enqueues\": %lld",
+               first ? "" : ",\n", r->queue, r->threads, r->producers, r->consumers,
+               placement_names[r->pin], r->cpu_list, r->seconds, ops, mops, r->enqueues, r->dequeues, r->empty_dequeues, r->full_enqueues);
+        if (r->has_latency) bench_print_latency(cfg, r);
+        if (r->has_perf) bench_print_perf(cfg, r);
+        if (cfg->reps > 1) bench_print_summary(cfg, r);
+        if (r->pipeline) bench_print_quantiles(cfg, "sojourn_ns", "sojourn", r->sojourn_ns);
+        if (r->open_loop) {
+            printf(", \"offered_load\": %.0f, \"achieved_load\": %.0f", r->offered_load, r->achieved_load);
+        }
+        if (r->has_mem) bench_print_mem(cfg, r);
+        if (r->has_lin) bench_print_lin(cfg, r);
+        printf("}");
+    } else {
+        printf("%-11s | %-7d | %-5d | %-5d | %-10.4f | %-10.2f | %-10lld | %-10lld\n",
+               r->queue, r->threads, r->producers, r->consumers, r->seconds, mops,
+               r->empty_dequeues, r->full_enqueues);
+        if (r->distinct_cpus) {
+            printf("    placement: %s on %d CPU%s, cpus=%s\n", placement_names[r->pin],
+                   r->distinct_cpus, r->distinct_cpus == 1 ? "" : "s", r->cpu_list);
+        }
+        if (r->open_loop) {
+            printf("    offered %.0f items/s, delivered %.0f items/s (%.1f%%)%s\n", r->offered_load,
+                   r->achieved_load, 100.0 * r->achieved_load / r->offered_load,
+                   r->achieved_load < OPEN_LOOP_SATURATED * r->offered_load ? " saturated" : "");
+        }
+        if (r->pipeline) bench_print_quantiles(cfg, "sojourn_ns", "sojourn", r->sojourn_ns);
+        if (r->has_latency) bench_print_latency(cfg, r);
+        if (r->has_perf) bench_print_perf(cfg, r);
+        if (cfg->reps > 1) bench_print_summary(cfg, r);
+        if (r->has_mem) bench_print_mem(cfg, r);
+        if (r->has_lin) bench_print_lin(cfg, r);
+        if (r->has_cas_stats) lfq_stats_print(stdout, &r->cas_stats, "    ");
+    }
+}
+
+static void bench_print_footer(const BenchConfig *cfg) {
+    if (cfg->format == FORMAT_JSON) printf("\n]\n");
+}
+
+static void bench_usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s bench [options]\n"
+        "  --queue NAME[,NAME...]   lfq, locked, multiqueue, bounded, shm, durable, stack,\n"
+        "                           pq, gen-mpmc, gen-bounded (default lfq,locked)\n"
+        "  --threads N[,N...]       thread counts to sweep (default 1,2,4,8,16,32)\n"
+        "  --ops N                  operations per thread (default 50000)\n"
+        "  --duration SEC           run each configuration for SEC seconds instead of --ops\n"
+        "  --enq-ratio R            enqueue share for mixed threads, 0..1 (default 0.5)\n"
+        "  --producers N            dedicated producer threads per run (default 0)\n"
+        "  --consumers N            dedicated consumer threads per run (default 0)\n"
+        "  --fill N                 items enqueued before timing starts (default 100)\n"
+        "  --payload BYTES          bytes written per enqueue and copied per dequeue (default 0)\n"
+        "  --capacity N             bounded, shm and durable queue capacity (default 1024)\n"
+        "  --shard-factor N         MultiQueue shards per thread (default 4)\n"
+        "  --shards N               fixed MultiQueue shard count, whatever the thread count;\n"
+        "                           the mean rank error is about N\n"
+        "  --latency                record per-op latency and report p50..p99.99/max\n"
+        "  --timer clock|rdtsc      latency timer: CLOCK_MONOTONIC_RAW or TSC (x86 only)\n"
+        "  --perf                   per-op cycles, instructions, LLC misses, context switches\n"
+        "  --perf-hitm RAW          also count HITM loads via this raw PMU event code (hex)\n"
+        "  --mem                    live allocations and bytes, bytes/item, allocator calls/op,\n"
+        "                           retired/dropped nodes and RSS\n"
+        "  --cas-stats              CAS attempts/failures, helping and retries (table format,\n"
+        "                           build with -DLFQ_STATS)\n"
+        "  --warmup N               discarded runs before each configuration (default 0)\n"
+        "  --reps N                 measured runs per configuration; >1 adds median, stddev,\n"
+        "                           95%% CI and outlier count (default 1)\n"
+        "  --pipeline PATTERN       producers stamp items, consumers record sojourn time;\n"
+        "                           PATTERN is steady, bursty or overload\n"
+        "  --rate N                 items/s per pipeline producer (default 100000)\n"
+        "  --burst N                items per burst for --pipeline bursty (default 64)\n"
+        "  --service-ns N           busy work per item in pipeline consumers (default 0)\n"
+        "  --open-loop PATTERN      pipeline on a precomputed schedule, latency from intended\n"
+        "                           send time; PATTERN is constant, poisson or bursty\n"
+        "  --load R[,R...]|auto     offered loads (items/s, all producers) for --open-loop;\n"
+        "                           auto doubles from 10000 until saturation (default)\n"
+        "  --persist flush|msync    how the durable queue makes writes durable (default flush)\n"
+        "  --check-lin              record every operation and check the history is a\n"
+        "                           linearizable FIFO; exits 1 if any run is not (needs --ops)\n"
+        "  --save FILE              append results to a JSON-lines result store\n"
+        "  --pin STRATEGY           none, compact, scatter, smt-pairs, one-per-core (default none)\n"
+        "  --format table|csv|json  output format (default table)\n",
+        prog);
+}
+
+// Parses "1,2,4" into out; returns the count or -1 on a malformed list
+static int parse_int_list(const char *s, int *out, int max) {
+    int n = 0;
+    while (*s) {
+        char *end;
+        long v = strtol(s, &end, 10);
+        if (end == s || v <= 0 || n == max) return -1;
+        out[n++] = (int)v;
+        s = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',') return -1;
+    }
+    return n;
+}
+
+// Same for positive decimal numbers such as "5e4,1e5"
+static int parse_double_list(const char *s, double *out, int max) {
+    int n = 0;
+    while (*s) {
+        char *end;
+        double v = strtod(s, &end);
+        if (end == s || v <= 0 || n == max) return -1;
+        out[n++] = v;
+        s = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',') return -1;
+    }
+    return n;
+}
+
+int bench_parse_args(BenchConfig *cfg, int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        const char *opt = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(opt, "--help") == 0 || strcmp(opt, "-h") == 0) {
+            return -1;
+        }
+        if (strcmp(opt, "--latency") == 0) {
+            cfg->latency = 1;
+            continue;
+        }
+        if (strcmp(opt, "--perf") == 0) {
+            cfg->perf = 1;
+            continue;
+        }
+        if (strcmp(opt, "--mem") == 0) {
+            cfg->mem = 1;
+            continue;
+        }
+        if (strcmp(opt, "--check-lin") == 0) {
+            cfg->check_lin = 1;
+            continue;
+        }
+        if (strcmp(opt, "--cas-stats") == 0) {
+            if (!LFQ_STATS_ENABLED) {
+                fprintf(stderr, "bench: --cas-stats needs a build with -DLFQ_STATS\n");
+                return -1;
+            }
+            cfg->cas_stats = 1;
+            continue;
+        }
+        if (val == NULL) {
+            fprintf(stderr, "bench: missing value for %s\n", opt);
+            return -1;
+        }
+        i++;
+
+        if (strcmp(opt, "--queue") == 0) {
+            static char names[256];
+            snprintf(names, sizeof(names), "%s", val);
+            cfg->num_queues = 0;
+            for (char *tok = strtok(names, ","); tok; tok = strtok(NULL, ",")) {
+                if (!bench_find_queue(tok)) {
+                    fprintf(stderr, "bench: unknown queue '%s'\n", tok);
+                    return -1;
+                }
+                if (cfg->num_queues == BENCH_MAX_QUEUES) {
+                    fprintf(stderr, "bench: too many queues (max %d)\n", BENCH_MAX_QUEUES);
+                    return -1;
+                }
+                cfg->queues[cfg->num_queues++] = tok;
+            }
+        } else if (strcmp(opt, "--threads") == 0) {
+            cfg->num_thread_counts = parse_int_list(val, cfg->threads, BENCH_MAX_THREAD_COUNTS);
+            if (cfg->num_thread_counts <= 0) {
+                fprintf(stderr, "bench: bad thread list '%s'\n", val);
+                return -1;
+            }
+        } else if (strcmp(opt, "--ops") == 0) {
+            cfg->ops = atoi(val);
+        } else if (strcmp(opt, "--duration") == 0) {
+            cfg->duration = atof(val);
+        } else if (strcmp(opt, "--enq-ratio") == 0) {
+            cfg->enq_ratio = atof(val);
+        } else if (strcmp(opt, "--producers") == 0) {
+            cfg->producers = atoi(val);
+        } else if (strcmp(opt, "--consumers") == 0) {
+            cfg->consumers = atoi(val);
+        } else if (strcmp(opt, "--fill") == 0) {
+            cfg->fill = atoi(val);
+        } else if (strcmp(opt, "--payload") == 0) {
+            cfg->payload = atoi(val);
+        } else if (strcmp(opt, "--capacity") == 0) {
+            cfg->capacity = atoi(val);
+        } else if (strcmp(opt, "--shard-factor") == 0) {
+            cfg->shard_factor = atoi(val);
+        } else if (strcmp(opt, "--shards") == 0) {
+            cfg->shards = atoi(val);
+        } else if (strcmp(opt, "--perf-hitm") == 0) {
+            cfg->perf = 1;
+            perf_hitm_raw = strtoull(val, NULL, 16);
+        } else if (strcmp(opt, "--timer") == 0) {
+            if (strcmp(val, "rdtsc") == 0) {
+                if (!lat_use_rdtsc()) {
+                    fprintf(stderr, "bench: rdtsc is not available on this architecture\n");
+                    return -1;
+                }
+            } else if (strcmp(val, "clock") != 0) {
+                fprintf(stderr, "bench: unknown timer '%s'\n", val);
+                return -1;
+            }
+        } else if (strcmp(opt, "--warmup") == 0) {
+            cfg->warmup = atoi(val);
+        } else if (strcmp(opt, "--reps") == 0) {
+            cfg->reps = atoi(val);
+        } else if (strcmp(opt, "--pipeline") == 0) {
+            cfg->pipeline = 1;
+            cfg->arrival = -1;
+            for (int k = 0; k < ARRIVAL_NUM; k++) {
+                if (strcmp(val, arrival_names[k]) == 0) cfg->arrival = k;
+            }
+            if (cfg->arrival < 0) {
+                fprintf(stderr, "bench: unknown arrival pattern '%s'\n", val);
+                return -1;
+            }
+        } else if (strcmp(opt, "--open-loop") == 0) {
+            cfg->pipeline = 1;
+            cfg->open_loop = 1;
+            if (strcmp(val, "constant") == 0) cfg->arrival = ARRIVAL_STEADY;
+            else if (strcmp(val, "poisson") == 0) cfg->arrival = ARRIVAL_POISSON;
+            else if (strcmp(val, "bursty") == 0) cfg->arrival = ARRIVAL_BURSTY;
+            else {
+                fprintf(stderr, "bench: unknown open-loop schedule '%s'\n", val);
+                return -1;
+            }
+        } else if (strcmp(opt, "--load") == 0) {
+            cfg->num_loads = 0;
+            if (strcmp(val, "auto") != 0) {
+                cfg->num_loads = parse_double_list(val, cfg->loads, BENCH_MAX_THREAD_COUNTS);
+                if (cfg->num_loads <= 0) {
+                    fprintf(stderr, "bench: bad load list '%s'\n", val);
+                    return -1;
+                }
+            }
+        } else if (strcmp(opt, "--rate") == 0) {
+            cfg->rate = atof(val);
+        } else if (strcmp(opt, "--burst") == 0) {
+            cfg->burst = atoi(val);
+        } else if (strcmp(opt, "--service-ns") == 0) {
+            cfg->service_ns = atoi(val);
+        } else if (strcmp(opt, "--persist") == 0) {
+            if (strcmp(val, "flush") == 0) cfg->persist = PERSIST_FLUSH;
+            else if (strcmp(val, "msync") == 0) cfg->persist = PERSIST_MSYNC;
+            else {
+                fprintf(stderr, "bench: unknown persist mode '%s'\n", val);
+                return -1;
+            }
+        } else if (strcmp(opt, "--save") == 0) {
+            cfg->save = val;
+        } else if (strcmp(opt, "--pin") == 0) {
+            cfg->pin = -1;
+            for (int k = 0; k < PLACE_NUM; k++) {
+                if (strcmp(val, placement_names[k]) == 0) cfg->pin = k;
+            }
+            if (cfg->pin < 0) {
+                fprintf(stderr, "bench: unknown placement '%s'\n", val);
+                return -1;
+            }
+        } else if (strcmp(opt, "--format") == 0) {
+            if (strcmp(val, "table") == 0) cfg->format = FORMAT_TABLE;
+            else if (strcmp(val, "csv") == 0) cfg->format = FORMAT_CSV;
+            else if (strcmp(val, "json") == 0) cfg->format = FORMAT_JSON;
+            else {
+                fprintf(stderr, "bench: unknown format '%s'\n", val);
+                return -1;
+            }
+        } else {
+            fprintf(stderr, "bench: unknown option %s\n", opt);
+            return -1;
+        }
+    }
+
+    if (cfg->ops <= 0 && cfg->duration <= 0) {
+        fprintf(stderr, "bench: need --ops > 0 or --duration > 0\n");
+        return -1;
+    }
+    if (cfg->pipeline && cfg->ops <= 0) {
+        fprintf(stderr, "bench: --pipeline needs --ops (items per producer)\n");
+        return -1;
+    }
+    if (cfg->check_lin && (cfg->duration > 0 || cfg->pipeline)) {
+        fprintf(stderr, "bench: --check-lin needs a fixed --ops and no --pipeline\n");
+        return -1;
+    }
+    for (int i = 0; cfg->check_lin && i < cfg->num_thread_counts; i++) {
+        if ((long long)cfg->threads[i] * cfg->ops > INT_MAX) {
+            fprintf(stderr, "bench: --check-lin values overflow; lower --ops or --threads\n");
+            return -1;
+        }
+    }
+    for (int i = 0; cfg->check_lin && i < cfg->num_queues; i++) {
+        if (bench_find_queue(cfg->queues[i])->fifo == FIFO_NONE) {
+            fprintf(stderr, "bench: --check-lin checks strict FIFO queues; %s is not one\n", cfg->queues[i]);
+            return -1;
+        }
+    }
+    if (cfg->open_loop && lat_timer == TIMER_RDTSC) {
+        fprintf(stderr, "bench: --open-loop schedules run on the raw clock; drop --timer rdtsc\n");
+        return -1;
+    }
+    if (cfg->enq_ratio < 0 || cfg->enq_ratio > 1 || cfg->producers < 0 || cfg->consumers < 0 ||
+        cfg->fill < 0 || cfg->payload < 0 || cfg->capacity <= 0 || cfg->shard_factor <= 0 ||
+        cfg->shards < 0 || cfg->warmup < 0 || cfg->reps <= 0 || cfg->reps > BENCH_MAX_REPS ||
+        cfg->rate <= 0 || cfg->burst <= 0 || cfg->service_ns < 0) {
+        fprintf(stderr, "bench: option out of range\n");
+        return -1;
+    }
+    return 0;
+}
+
+// -------- Result store and regression comparison --------
+// `bench --save FILE` appends one JSON object per line and configuration.
+// Records are keyed by host and a canonical configuration string, and carry
+// the per-repetition samples so `compare` can run a significance test
+// instead of diffing two single numbers. Bump RESULT_STORE_VERSION when the
+// record layout changes; compare skips records of other versions.
+#define RESULT_STORE_VERSION 1
+#define RESULT_KEY_LEN 256
+
+static void bench_result_key(const BenchConfig *cfg, const BenchResult *r, char *key, size_t len) {
+    int n = snprintf(key, len, "queue=%s threads=%d producers=%d consumers=%d enq_ratio=%.2f "
+                     "fill=%d payload=%d capacity=%d shard_factor=%d pin=%s",
+                     r->queue, r->threads, r->producers, r->consumers, cfg->enq_ratio,
+                     cfg->fill, cfg->payload, cfg->capacity, cfg->shard_factor,
+                     placement_names[r->pin]);
+    if (n > 0 && (size_t)n < len && cfg->pipeline) {
+        n += snprintf(key + n, len - n, " pipeline=%s rate=%g burst=%d service_ns=%d",
+                      arrival_names[cfg->arrival], cfg->open_loop ? r->offered_load : cfg->rate,
+                      cfg->burst, cfg->service_ns);
+    }
+    if (n > 0 && (size_t)n < len && cfg->open_loop) {
+        n += snprintf(key + n, len - n, " open_loop=1");
+    }
+    if (n > 0 && (size_t)n < len && cfg->shards > 0) {
+        n += snprintf(key + n, len - n, " shards=%d", cfg->shards);
+    }
+    if (n > 0 && (size_t)n < len && strcmp(r->queue, "durable") == 0) {
+        n += snprintf(key + n, len - n, " persist=%s", persist_names[cfg->persist]);
+    }
+    if (n > 0 && (size_t)n < len) {
+        if (cfg->duration > 0) snprintf(key + n, len - n, " duration=%g", cfg->duration);
+        else snprintf(key + n, len - n, " ops=%d", cfg->ops);
+    }
+}
+
+static void print_json_array(FILE *f, const char *name, const double *v, int n) {
+    fprintf(f, ", \"%s\": [", name);
+    for (int i = 0; i < n; i++) fprintf(f, "%s%.6g", i ? ", " : "", v[i]);
+    fprintf(f, "]");
+}
+
+void bench_save_result(FILE *f, const BenchConfig *cfg, const BenchResult *r, const char *host) {
+    char key[RESULT_KEY_LEN];
+    bench_result_key(cfg, r, key, sizeof(key));
+    fprintf(f, "{\"version\": %d, \"host\": \"%s\", \"time\": %lld, \"key\": \"%s\"",
+            RESULT_STORE_VERSION, host, (long long)time(NULL), key);
+    print_json_array(f, "mops", r->mops_samples, r->mops.n);
+    if (r->has_latency) {
+        print_json_array(f, "enq_p99_ns", r->enq_p99_samples, r->mops.n);
+        print_json_array(f, "deq_p99_ns", r->deq_p99_samples, r->mops.n);
+    }
+    fprintf(f, "}\n");
+}
+
+// Minimal readers for the records written above (not a general JSON parser)
+static int json_get_string(const char *line, const char *field, char *out, size_t len) {
+    char pat[64];
+    snprintf(pat, sizeof(pat), "\"%s\": \"", field);
+    const char *p = strstr(line, pat);
+    if (p == NULL) return 0;
+    p += strlen(pat);
+    const char *end = strchr(p, '"');
+    if (end == NULL || (size_t)(end - p) >= len) return 0;
+    memcpy(out, p, end - p);
+    out[end - p] = '\0';
+    return 1;
+}
+
+static int json_get_numbers(const char *line, const char *field, double *out, int max) {
+    char pat[64];
+    snprintf(pat, sizeof(pat), "\"%s\": ", field);
+    const char *p = strstr(line, pat);
+    if (p == NULL) return 0;
+    p += strlen(pat);
+    if (*p != '[') {
+        out[0] = strtod(p, NULL);
+        return 1;
+    }
+    int n = 0;
+    for (p++; *p && *p != ']' && n < max;) {
+        char *end;
+        double v = strtod(p, &end);
+        if (end == p) break;
+        out[n++] = v;
+        p = end;
+        while (*p == ',' || *p == ' ') p++;
+    }
+    return n;
+}
+
+typedef struct {
+    char host[128];
+    char key[RESULT_KEY_LEN];
+    double mops[BENCH_MAX_REPS];
+    double enq_p99[BENCH_MAX_REPS];
+    double deq_p99[BENCH_MAX_REPS];
+    int n_mops, n_enq, n_deq;
+} StoredResult;
+
+// Loads every current-version record; a later record replaces an earlier one
+// with the same host and key. Returns the count or -1 if the file can't be read.
+static int result_store_load(const char *path, StoredResult **out) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return -1;
+
+    int n = 0, cap = 16;
+    StoredResult *recs = xmalloc(cap * sizeof(StoredResult));
+    char line[8192];
+    while (fgets(line, sizeof(line), f)) {
+        double version;
+        StoredResult r;
+        if (json_get_numbers(line, "version", &version, 1) != 1 ||
+            (int)version != RESULT_STORE_VERSION ||
+            !json_get_string(line, "host", r.host, sizeof(r.host)) ||
+            !json_get_string(line, "key", r.key, sizeof(r.key))) {
+            continue;
+        }
+        r.n_mops = json_get_numbers(line, "mops", r.mops, BENCH_MAX_REPS);
+        r.n_enq = json_get_numbers(line, "enq_p99_ns", r.enq_p99, BENCH_MAX_REPS);
+        r.n_deq = json_get_numbers(line, "deq_p99_ns", r.deq_p99, BENCH_MAX_REPS);
+
+        int i = 0;
+        while (i < n && (strcmp(recs[i].key, r.key) != 0 || strcmp(recs[i].host, r.host) != 0)) i++;
+        if (i == n) {
+            if (n == cap) {
+                cap *= 2;
+                recs = realloc(recs, cap * sizeof(StoredResult));
+                if (recs == NULL) {
+                    perror("Failed to allocate result store");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            n++;
+        }
+        recs[i] = r;
+    }
+    fclose(f);
+    *out = recs;
+    return n;
+}
+
+// Compares one metric; direction is +1 when larger is better (throughput) and
+// -1 when smaller is better (latency). Returns 1 for a significant regression.
+static int compare_metric(const char *name, const double *a, int na, const double *b, int nb,
+                          int direction, double threshold) {
+    if (na == 0 || nb == 0) return 0;
+    BenchSummary sa, sb;
+    double t, df;
+    bench_summarize(a, na, &sa);
+    bench_summarize(b, nb, &sb);
+    double change = sa.mean != 0.0 ? (sb.mean - sa.mean) / sa.mean * 100.0 : 0.0;
+    int sig = welch_t_test(a, na, b, nb, &t, &df);
+    int worse = direction * change < -threshold;
+    int regression = sig == 1 && worse;
+
+    printf("    %-11s %12.4g -> %-12.4g %+7.2f%%  ", name, sa.mean, sb.mean, change);
+    if (sig < 0) printf("(need --reps >= 2 on both sides)\n");
+    else if (regression) printf("REGRESSION (t=%.2f, df=%.1f)\n", t, df);
+    else if (sig == 1 && direction * change > threshold) printf("improved (t=%.2f, df=%.1f)\n", t, df);
+    else printf("%s\n", sig == 1 ? "within threshold" : "not significant");
+    return regression;
+}
+
+static void compare_usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s compare BASELINE.jsonl CANDIDATE.jsonl [--threshold PCT]\n"
+        "  Flags a regression when Welch's t-test is significant at the 5%% level and\n"
+        "  throughput drops (or p99 latency rises) by more than PCT percent (default 2).\n"
+        "  Exit status: 0 no regression, 1 regression, 2 usage or I/O error.\n",
+        prog);
+}
+
+int compare_main(int argc, char **argv, const char *prog) {
+    double threshold = 2.0;
+    if (argc != 3 && !(argc == 5 && strcmp(argv[3], "--threshold") == 0)) {
+        compare_usage(prog);
+        return 2;
+    }
+    if (argc == 5) threshold = atof(argv[4]);
+
+    StoredResult *base, *cand;
+    int nb = result_store_load(argv[1], &base);
+    if (nb < 0) {
+        perror(argv[1]);
+        return 2;
+    }
+    int nc = result_store_load(argv[2], &cand);
+    if (nc < 0) {
+        perror(argv[2]);
+        free(base);
+        return 2;
+    }
+
+    int matched = 0, regressions = 0;
+    for (int i = 0; i < nc; i++) {
+        const StoredResult *c = &cand[i];
+        const StoredResult *b = NULL;
+        for (int j = 0; j < nb && b == NULL; j++) {
+            if (strcmp(base[j].key, c->key) == 0 && strcmp(base[j].host, c->host) == 0) b = &base[j];
+        }
+        if (b == NULL) continue;
+        matched++;
+        printf("%s [%s]\n", c->key, c->host);
+        regressions += compare_metric("Mops/s", b->mops, b->n_mops, c->mops, c->n_mops, 1, threshold);
+        regressions += compare_metric("enq p99 ns", b->enq_p99, b->n_enq, c->enq_p99, c->n_enq, -1, threshold);
+        regressions += compare_metric("deq p99 ns", b->deq_p99, b->n_deq, c->deq_p99, c->n_deq, -1, threshold);
+    }
+
+    printf("\n%d configuration%s compared, %d regression%s\n", matched, matched == 1 ? "" : "s",
+           regressions, regressions == 1 ? "" : "s");
+    if (matched == 0) {
+        fprintf(stderr, "compare: no configuration appears in both files for the same host\n");
+    }
+    free(base);
+    free(cand);
+    return regressions > 0 ? 1 : 0;
+}
+
+int bench_main(int argc, char **argv, const char *prog) {
+    BenchConfig cfg;
+    bench_config_defaults(&cfg);
+    if (bench_parse_args(&cfg, argc, argv) != 0) {
+        bench_usage(prog);
+        return 2;
+    }
+
+    CpuTopology topology;
+    if (cfg.pin != PLACE_NONE) {
+        if (!topology_discover(&topology)) {
+            fprintf(stderr, "bench: cannot read CPU topology, running unpinned\n");
+            cfg.pin = PLACE_NONE;
+        } else {
+            cfg.topology = &topology;
+            if (cfg.format == FORMAT_TABLE) {
+                printf("Topology: %d package%s, %d core%s, %d CPU%s available\n\n",
+                       topology.num_packages, topology.num_packages == 1 ? "" : "s",
+                       topology.num_cores, topology.num_cores == 1 ? "" : "s",
+                       topology.num_cpus, topology.num_cpus == 1 ? "" : "s");
+            }
+        }
+    }
+
+    FILE *store = NULL;
+    char host[128] = "unknown";
+    if (cfg.save) {
+        store = fopen(cfg.save, "a");
+        if (store == NULL) {
+            perror(cfg.save);
+            return 2;
+        }
+        gethostname(host, sizeof(host));
+        host[sizeof(host) - 1] = '\0';
+    }
+
+    bench_print_header(&cfg);
+    int first = 1;
+    int violations = 0;
+    for (int qi = 0; qi < cfg.num_queues; qi++) {
+        const BenchQueueOps *ops = bench_find_queue(cfg.queues[qi]);
+        for (int ti = 0; ti < cfg.num_thread_counts; ti++) {
+            // Open loop sweeps offered load: the given list, or doubling until saturated
+            int steps = !cfg.open_loop ? 1 : cfg.num_loads ? cfg.num_loads : OPEN_LOOP_MAX_STEPS;
+            double load = OPEN_LOOP_START_LOAD;
+            for (int li = 0; li < steps; li++) {
+                BenchResult r;
+                if (cfg.open_loop) cfg.offered_load = cfg.num_loads ? cfg.loads[li] : load;
+                if (bench_run_repeated(&cfg, ops, cfg.threads[ti], &r) != 0) {
+                    fprintf(stderr, "bench: skipping %d threads (too few for the producer/consumer split)\n",
+                            cfg.threads[ti]);
+                    break;
+                }
+                bench_print_result(&cfg, &r, first);
+                if (r.has_lin && bench_lin_failed(ops, &r.lin)) violations++;
+                if (store) bench_save_result(store, &cfg, &r, host);
+                first = 0;
+                if (cfg.open_loop && !cfg.num_loads) {
+                    if (r.achieved_load < OPEN_LOOP_SATURATED * r.offered_load) break;
+                    load *= 2;
+                }
+            }
+        }
+    }
+    bench_print_footer(&cfg);
+    if (store) fclose(store);
+    if (cfg.topology) topology_destroy(&topology);
+    return violations ? 1 : 0;
+}
+
+// Default sweep used by main(): 50/50 mix, 100 items pre-filled, one warmup
+// run and `reps` measured ones. Returns the median run's time; the
+// throughput summary goes to *mops when it is not NULL.
+double run_benchmark(int num_threads, int use_lock_free, int ops, int reps, BenchSummary *mops) {
+    BenchConfig cfg;
+    BenchResult r;
+
+    bench_config_defaults(&cfg);
+    cfg.ops = ops;
+    cfg.warmup = 1;
+    cfg.reps = reps;
+    bench_run_repeated(&cfg, bench_find_queue(use_lock_free ? "lfq" : "locked"), num_threads, &r);
+    if (mops) *mops = r.mops;
+    return r.seconds;
+}
+
+// Same driver and workload as run_benchmark, for the durable queue modes
+double run_durable_benchmark(const char *queue, int persist, int num_threads, int ops, BenchSummary *mops) {
+    BenchConfig cfg;
+    BenchResult r;
+
+    bench_config_defaults(&cfg);
+    cfg.ops = ops;
+    cfg.warmup = 1;
+    cfg.reps = 3;
+    cfg.capacity = 1 << 16;
+    cfg.persist = persist;
+    bench_run_repeated(&cfg, bench_find_queue(queue), num_threads, &r);
+    if (mops) *mops = r.mops;
+    return r.seconds;
+}
+
+// Seconds dq_open takes to recover a file holding items items
+double run_recovery_benchmark(int items) {
+    char path[64];
+    snprintf(path, sizeof(path), "/var/tmp/lfq-recovery-%d.dat", (int)getpid());
+    unlink(path);
+    DurableQueue q;
+    if (!dq_open(&q, path, (uint32_t)items, PERSIST_NONE)) {
+        perror(path);
+        exit(1);
+    }
+    for (int i = 0; i < items; i++) {
+        dq_enqueue(&q, i);
+    }
+    dq_close(&q);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int ok = dq_open(&q, path, (uint32_t)items, PERSIST_FLUSH);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (ok) dq_close(&q);
+    unlink(path);
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// -------- Relaxed MultiQueue benchmark ---------
+
+typedef struct {
+    MultiQueue *mq;
+    int operations;
+    int id;
+    _Atomic(int) *order;    // Global dequeue ordinal (rank phase)
+    int *log_value;         // Dequeued value indexed by ordinal (rank phase)
+} MQThreadArgs;
+
+void *mq_worker(void *arg) {
+    MQThreadArgs *t = (MQThreadArgs *)arg;
+    unsigned int seed = t->id;
+
+    for (int i = 0; i < t->operations; i++) {
+        int val;
+        if (rand_r(&seed) % 2 == 0) multiqueue_enqueue(t->mq, i);
+        else multiqueue_dequeue(t->mq, &val);
+    }
+    return NULL;
+}
+
+// The ordinal is taken after the dequeue returns, not at its linearization
+// point (the head CAS inside the shard), so the log order is the completion
+// order. Two dequeues that finish close together may be logged swapped,
+// which adds up to threads - 1 to a dequeue's measured rank error, and more
+// if a thread is descheduled between its CAS and the fetch_add. The mean is
+// barely affected; treat the max as an upper bound.
+void *mq_drain_worker(void *arg) {
+    MQThreadArgs *t = (MQThreadArgs *)arg;
+    int val;
+    while (multiqueue_dequeue(t->mq, &val)) {
+        t->log_value[atomic_fetch_add(t->order, 1)] = val;
+    }
+    return NULL;
+}
+
+// Rank error of each dequeue = number of smaller values still in the queue,
+// counted with a Fenwick tree over the values removed so far.
+static void mq_rank_error(const int *log_value, int n, double *mean, int *max) {
+    int *tree = calloc(n + 1, sizeof(int));
+    long long total = 0;
+    *max = 0;
+
+    for (int i = 0; i < n; i++) {
+        int v = log_value[i];
+        int removed_below = 0;
+        for (int j = v; j > 0; j -= j & -j) removed_below += tree[j];
+        int rank = v - removed_below;
+        total += rank;
+        if (rank > *max) *max = rank;
+        for (int j = v + 1; j <= n; j += j & -j) tree[j]++;
+    }
+
+    *mean = n > 0 ? (double)total / n : 0.0;
+    free(tree);
+}
+
+double run_multiqueue_benchmark(int num_threads, int num_shards, int ops,
+                                double *mean_rank, int *max_rank) {
+    pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+    MQThreadArgs *args = malloc(num_threads * sizeof(MQThreadArgs));
+
+    // Throughput phase: same 50/50 mix as worker()
+    MultiQueue mq;
+    retired_list_init();
+    multiqueue_init(&mq, num_shards);
+    for (int i = 0; i < 100; i++) {
+        multiqueue_enqueue(&mq, i);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < num_threads; i++) {
+        args[i].mq = &mq;
+        args[i].operations = ops;
+        args[i].id = i;
+        pthread_create(&threads[i], NULL, mq_worker, &args[i]);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    multiqueue_destroy(&mq);
+    retired_list_cleanup();
+
+    // Rank phase: prefill in order, drain concurrently, then score the log
+    int items = ops;
+    int *log_value = malloc(items * sizeof(int));
+    _Atomic(int) order = 0;
+    retired_list_init();
+    multiqueue_init(&mq, num_shards);
+    for (int i = 0; i < items; i++) {
+        multiqueue_enqueue(&mq, i);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        args[i].order = &order;
+        args[i].log_value = log_value;
+        pthread_create(&threads[i], NULL, mq_drain_worker, &args[i]);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    mq_rank_error(log_value, atomic_load(&order), mean_rank, max_rank);
+    multiqueue_destroy(&mq);
+    retired_list_cleanup();
+
+    free(log_value);
+    free(threads);
+    free(args);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+
+// -------- Priority queue benchmark ------------
+
+typedef struct {
+    int use_lock_free;
+    int operations;
+    LFPriorityQueue *lfq;
+    LockedPQ *lq;
+    int id;
+} PQThreadArgs;
+
+void *pq_worker(void *arg) {
+    PQThreadArgs *t = (PQThreadArgs *)arg;
+    unsigned int seed = t->id;
+
+    for (int i = 0; i < t->operations; i++) {
+        int r = rand_r(&seed);
+        int key;
+
+        if (t->use_lock_free) {
+            if (r % 2 == 0) lfpq_insert(t->lfq, r % 100000, i);
+            else lfpq_delete_min(t->lfq, &key, NULL);
+        } else {
+            if (r % 2 == 0) lockedpq_insert(t->lq, r % 100000, i);
+            else lockedpq_delete_min(t->lq, &key, NULL);
+        }
+    }
+    return NULL;
+}
+
+double run_pq_benchmark(int num_threads, int use_lock_free, int ops) {
+    pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+    PQThreadArgs *args = malloc(num_threads * sizeof(PQThreadArgs));
+
+    LFPriorityQueue lfq;
+    LockedPQ lq;
+
+    if (use_lock_free) {
+        retired_list_init();
+        lfpq_init(&lfq);
+        for (int i = 0; i < 100; i++) {
+            lfpq_insert(&lfq, i * 1000, i);
+        }
+    } else {
+        lockedpq_init(&lq);
+        for (int i = 0; i < 100; i++) {
+            lockedpq_insert(&lq, i * 1000, i);
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < num_threads; i++) {
+        args[i].use_lock_free = use_lock_free;
+        args[i].operations = ops;
+        args[i].lfq = &lfq;
+        args[i].lq = &lq;
+        args[i].id = i;
+        pthread_create(&threads[i], NULL, pq_worker, &args[i]);
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (use_lock_free) {
+        lfpq_destroy(&lfq);
+        retired_list_cleanup();
+    } else {
+        lockedpq_destroy(&lq);
+    }
+
+    free(threads);
+    free(args);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// -------- Stack elimination benchmark ---------
+
+typedef struct {
+    LFStack *s;
+    int operations;
+    int id;
+} StackThreadArgs;
+
+void *stack_worker(void *arg) {
+    StackThreadArgs *t = (StackThreadArgs *)arg;
+    unsigned int seed = t->id;
+
+    for (int i = 0; i < t->operations; i++) {
+        int val;
+        if (rand_r(&seed) % 2 == 0) lfstack_push(t->s, i);
+        else lfstack_pop(t->s, &val);
+    }
+    return NULL;
+}
+
+double run_stack_benchmark(int num_threads, int use_elimination, int ops) {
+    pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+    StackThreadArgs *args = malloc(num_threads * sizeof(StackThreadArgs));
+
+    LFStack s;
+    retired_list_init();
+    lfstack_init(&s, use_elimination);
+    for (int i = 0; i < 100; i++) {
+        lfstack_push(&s, i);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < num_threads; i++) {
+        args[i].s = &s;
+        args[i].operations = ops;
+        args[i].id = i;
+        pthread_create(&threads[i], NULL, stack_worker, &args[i]);
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    lfstack_destroy(&s);
+    retired_list_cleanup();
+
+    free(threads);
+    free(args);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// -------- Multicast fan-out benchmark ---------
+// One producer, three consumers: a single ring vs one LFQueue per consumer.
+
+typedef struct {
+    LFQueue *queues;
+    int num_queues;
+    int id;
+    int count;
+} FanoutArgs;
+
+void *fanout_producer(void *arg) {
+    FanoutArgs *t = (FanoutArgs *)arg;
+    for (int i = 0; i < t->count; i++) {
+        for (int q = 0; q < t->num_queues; q++) {
+            lfqueue_enqueue(&t->queues[q], i);
+        }
+    }
+    return NULL;
+}
+
+void *fanout_consumer(void *arg) {
+    FanoutArgs *t = (FanoutArgs *)arg;
+    int received = 0;
+    int val;
+    while (received < t->count) {
+        if (lfqueue_dequeue(&t->queues[t->id], &val)) received++;
+        else sched_yield();
+    }
+    return NULL;
+}
+
+double run_fanout_benchmark(int use_ring, int events) {
+    enum { CONSUMERS = 3 };
+    pthread_t producer, consumers[CONSUMERS];
+    struct timespec start, end;
+
+    MulticastRing r;
+    LFQueue queues[CONSUMERS];
+    RingArgs rargs[CONSUMERS + 1];
+    FanoutArgs fargs[CONSUMERS + 1];
+
+    if (use_ring) {
+        ring_init(&r, 1024, 0);
+        for (int i = 0; i < CONSUMERS; i++) {
+            ring_add_consumer(&r, NULL, 0);
+        }
+    } else {
+        retired_list_init();
+        for (int i = 0; i < CONSUMERS; i++) {
+            lfqueue_init(&queues[i]);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < CONSUMERS; i++) {
+        if (use_ring) {
+            rargs[i] = (RingArgs){&r, i, events, 0, 1};
+            pthread_create(&consumers[i], NULL, ring_consumer_thread, &rargs[i]);
+        } else {
+            fargs[i] = (FanoutArgs){queues, CONSUMERS, i, events};
+            pthread_create(&consumers[i], NULL, fanout_consumer, &fargs[i]);
+        }
+    }
+    if (use_ring) {
+        rargs[CONSUMERS] = (RingArgs){&r, 0, events, 0, 1};
+        pthread_create(&producer, NULL, ring_producer_thread, &rargs[CONSUMERS]);
+    } else {
+        fargs[CONSUMERS] = (FanoutArgs){queues, CONSUMERS, 0, events};
+        pthread_create(&producer, NULL, fanout_producer, &fargs[CONSUMERS]);
+    }
+
+    pthread_join(producer, NULL);
+    for (int i = 0; i < CONSUMERS; i++) {
+        pthread_join(consumers[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (use_ring) {
+        ring_destroy(&r);
+    } else {
+        for (int i = 0; i < CONSUMERS; i++) {
+            lfqueue_destroy(&queues[i]);
+        }
+        retired_list_cleanup();
+    }
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// -------- Overload / backpressure benchmark ---------
+// Producers outrun a consumer that does extra work per item. The unbounded
+// queue grows with the backlog; the bounded queue holds at most its capacity.
+
+typedef struct {
+    int use_bounded;
+    LFQueue *lfq;
+    BoundedQueue *bq;
+    int count;
+    _Atomic(int) *producers_left;
+    int peak;
+} OverloadArgs;
+
+void *overload_producer(void *arg) {
+    OverloadArgs *t = (OverloadArgs *)arg;
+    for (int i = 0; i < t->count; i++) {
+        if (t->use_bounded) bq_enqueue_timed(t->bq, i, -1);
+        else lfqueue_enqueue(t->lfq, i);
+    }
+    atomic_fetch_sub(t->producers_left, 1);
+    return NULL;
+}
+
+void *overload_consumer(void *arg) {
+    OverloadArgs *t = (OverloadArgs *)arg;
+    volatile unsigned int work = 0;
+    int val;
+
+    while (true) {
+        int size = t->use_bounded ? bq_size(t->bq) : lfqueue_size(t->lfq);
+        if (size > t->peak) t->peak = size;
+
+        int got = t->use_bounded ? bq_dequeue(t->bq, &val) : lfqueue_dequeue(t->lfq, &val);
+        if (got) {
+            for (int i = 0; i < 200; i++) work += i; // Slow consumer
+        } else if (atomic_load(t->producers_left) == 0) {
+            break;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+double run_overload_benchmark(int use_bounded, int producers, int items, int *peak) {
+    pthread_t *threads = malloc((producers + 1) * sizeof(pthread_t));
+    LFQueue lfq;
+    BoundedQueue bq;
+    _Atomic(int) producers_left = producers;
+
+    if (use_bounded) {
+        bq_init(&bq, 1024);
+    } else {
+        retired_list_init();
+        lfqueue_init(&lfq);
+    }
+
+    OverloadArgs args = {use_bounded, &lfq, &bq, items, &producers_left, 0};
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_create(&threads[producers], NULL, overload_consumer, &args);
+    for (int i = 0; i < producers; i++) {
+        pthread_create(&threads[i], NULL, overload_producer, &args);
+    }
+    for (int i = 0; i <= producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (use_bounded) {
+        bq_destroy(&bq);
+    } else {
+        lfqueue_destroy(&lfq);
+        retired_list_cleanup();
+    }
+    free(threads);
+
+    *peak = args.peak;
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// -------- Specialized hand-off -----
+// One producer thread passes items to the calling thread. Each queue gets its
+// own copy of the loop, so the generated operations inline into it.
+typedef struct {
+    void *q;
+    int items;
+} HandoffArgs;
+
+#define BENCH_HANDOFF(name) \
+    static void *name##_handoff_producer(void *arg) { \
+        HandoffArgs *a = (HandoffArgs *)arg; \
+        for (int i = 0; i < a->items; i++) { \
+            while (!name##_enqueue(a->q, i)) sched_yield(); \
+        } \
+        return NULL; \
+    } \
+    static double name##_handoff(int items, size_t capacity) { \
+        name q; \
+        retired_list_init(); \
+        name##_init(&q, capacity); \
+        HandoffArgs a = {&q, items}; \
+        pthread_t producer; \
+        struct timespec start, end; \
+        clock_gettime(CLOCK_MONOTONIC, &start); \
+        pthread_create(&producer, NULL, name##_handoff_producer, &a); \
+        int v; \
+        for (int got = 0; got < items;) { \
+            if (name##_dequeue(&q, &v)) got++; \
+            else sched_yield(); \
+        } \
+        pthread_join(producer, NULL); \
+        clock_gettime(CLOCK_MONOTONIC, &end); \
+        name##_destroy(&q); \
+        retired_list_cleanup(); \
+        return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9; \
+    }
+
+// LFQueue under the generated names, as the baseline
+typedef LFQueue handoff_lfq;
+static inline void handoff_lfq_init(handoff_lfq *q, size_t capacity) { (void)capacity; lfqueue_init(q); }
+static inline void handoff_lfq_destroy(handoff_lfq *q) { lfqueue_destroy(q); }
+static inline int handoff_lfq_enqueue(handoff_lfq *q, int v) { return lfqueue_enqueue(q, v); }
+static inline int handoff_lfq_dequeue(handoff_lfq *q, int *v) { return lfqueue_dequeue(q, v); }
+
+LFQ_DEFINE(handoff_spsc, int, SPSC, UNBOUNDED, FREE)
+LFQ_DEFINE(handoff_mpsc, int, MPSC, UNBOUNDED, FREE)
+LFQ_DEFINE(handoff_spsc_ring, int, SPSC, BOUNDED, NONE)
+
+BENCH_HANDOFF(handoff_lfq)
+BENCH_HANDOFF(bench_gen_mpmc)
+BENCH_HANDOFF(handoff_mpsc)
+BENCH_HANDOFF(handoff_spsc)
+BENCH_HANDOFF(bench_gen_ring)
+BENCH_HANDOFF(handoff_spsc_ring)
+
+// One producer process hands items to the parent, either through a
+// shared-memory queue or one write() per item on a Unix socket pair
+double run_ipc_benchmark(int use_shm, int items) {
+    char name[64];
+    snprintf(name, sizeof(name), "/lfq-ipc-%d", (int)getpid());
+    ShmQueue q;
+    int fds[2] = {-1, -1};
+    if (use_shm) {
+        if (!shmq_open(&q, name, 1024)) {
+            perror("shm_open");
+            exit(1);
+        }
+    } else if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        perror("socketpair");
+        exit(1);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (use_shm) {
+            ShmQueue child;
+            if (!shmq_open(&child, name, 1024)) _exit(1);
+            for (int i = 0; i < items; i++) {
+                while (!shmq_enqueue(&child, i)) sched_yield();
+            }
+            shmq_close(&child);
+        } else {
+            close(fds[0]);
+            for (int i = 0; i < items; i++) {
+                if (write(fds[1], &i, sizeof(i)) != sizeof(i)) _exit(1);
+            }
+        }
+        _exit(0);
+    }
+
+    int value;
+    if (use_shm) {
+        for (int received = 0; received < items;) {
+            if (shmq_dequeue(&q, &value)) received++;
+            else sched_yield();
+        }
+    } else {
+        close(fds[1]);
+        for (int received = 0; received < items; received++) {
+            if (read(fds[0], &value, sizeof(value)) != sizeof(value)) break;
+        }
+        close(fds[0]);
+    }
+    waitpid(pid, NULL, 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (use_shm) {
+        shmq_close(&q);
+        shmq_unlink(name);
+    }
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// =======================
+// Main function
+// =======================
+
+// `lfq_bench bench ...` and `lfq_bench compare ...` run the configurable
+// driver; with no arguments the fixed sweep below runs every structure.
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return bench_main(argc - 1, argv + 1, argv[0]);
+    }
+    if (argc > 1 && strcmp(argv[1], "compare") == 0) {
+        return compare_main(argc - 1, argv + 1, argv[0]);
+    }
+
+    printf("--- PERFORMANCE BENCHMARKS ---\n");
+    int threads[] = {1, 2, 4, 8, 16, 32};
+    int num_tests = 6;
+    int ops = 50000;
+
+    int reps = 5;
+
+    printf("Operations per thread: %d, median of %d runs after 1 warmup\n", ops, reps);
+    printf("%-8s | %-15s | %-15s | %-10s | %-11s\n", "Threads", "Lock-Based (s)", "Lock-Free (s)",
+           "Speedup", "Significant");
+    printf("---------------------------------------------------------------------------\n");
+
+    for (int i = 0; i < num_tests; i++) {
+        int t = threads[i];
+        BenchSummary mops_locked, mops_free;
+        double time_locked = run_benchmark(t, 0, ops, reps, &mops_locked);
+        double time_free = run_benchmark(t, 1, ops, reps, &mops_free);
+        double speedup = time_locked / time_free;
+        // Only call a difference real when the 95% confidence intervals do not overlap
+        int significant = mops_free.ci95_lo > mops_locked.ci95_hi ||
+                          mops_locked.ci95_lo > mops_free.ci95_hi;
+
+        char speedup_str[16];
+        snprintf(speedup_str, sizeof(speedup_str), "%.2fx", speedup);
+        printf("%-8d | %-15.4f | %-15.4f | %-10s | %s\n", t, time_locked, time_free,
+               speedup_str, significant ? "yes" : "no (CIs overlap)");
+    }
+
+    // Relaxed MultiQueue: throughput vs rank error for two shard factors
+    printf("\n--- RELAXED MULTIQUEUE BENCHMARK ---\n");
+    printf("%-8s | %-7s | %-12s | %-10s | %-9s\n", "Threads", "Shards", "Mops/s", "Mean rank", "Max rank");
+    printf("-------------------------------------------------------------\n");
+    for (int i = 0; i < num_tests; i++) {
+        int t = threads[i];
+        for (int factor = 2; factor <= 4; factor += 2) {
+            double mean_rank;
+            int max_rank;
+            double secs = run_multiqueue_benchmark(t, factor * t, ops, &mean_rank, &max_rank);
+            printf("%-8d | %-7d | %-12.2f | %-10.1f | %-9d\n",
+                   t, factor * t, (double)t * ops / secs / 1e6, mean_rank, max_rank);
+        }
+    }
+
+    // Priority queue: same thread sweep as run_benchmark
+    printf("\n--- PRIORITY QUEUE BENCHMARK ---\n");
+    printf("%-8s | %-15s | %-15s | %-10s\n", "Threads", "Lock-Based (s)", "Lock-Free (s)", "Speedup");
+    printf("-------------------------------------------------------------\n");
+    for (int i = 0; i < num_tests; i++) {
+        int t = threads[i];
+        double time_locked = run_pq_benchmark(t, 0, ops);
+        double time_free = run_pq_benchmark(t, 1, ops);
+        printf("%-8d | %-15.4f | %-15.4f | %.2fx\n", t, time_locked, time_free, time_locked / time_free);
+    }
+
+    // Treiber stack with and without elimination, 1 to 64 threads
+    printf("\n--- STACK ELIMINATION BENCHMARK ---\n");
+    printf("%-8s | %-15s | %-15s | %-10s\n", "Threads", "Treiber (s)", "Elimination (s)", "Speedup");
+    printf("-------------------------------------------------------------\n");
+    int stack_threads[] = {1, 2, 4, 8, 16, 32, 64};
+    for (int i = 0; i < 7; i++) {
+        int t = stack_threads[i];
+        double time_plain = run_stack_benchmark(t, 0, ops);
+        double time_elim = run_stack_benchmark(t, 1, ops);
+        printf("%-8d | %-15.4f | %-15.4f | %.2fx\n", t, time_plain, time_elim, time_plain / time_elim);
+    }
+
+    // Fan-out to three consumers: one shared ring vs one queue per consumer
+    printf("\n--- MULTICAST FAN-OUT BENCHMARK (1 producer, 3 consumers) ---\n");
+    int events = 200000;
+    double time_queues = run_fanout_benchmark(0, events);
+    double time_ring = run_fanout_benchmark(1, events);
+    printf("%-22s | %-10s | %-12s\n", "Structure", "Time (s)", "Mevents/s");
+    printf("-------------------------------------------------------------\n");
+    printf("%-22s | %-10.4f | %-12.2f\n", "LFQueue per consumer", time_queues, events / time_queues / 1e6);
+    printf("%-22s | %-10.4f | %-12.2f\n", "Multicast ring", time_ring, events / time_ring / 1e6);
+
+    // Overload: 4 producers x 50000 items against one slow consumer
+    printf("\n--- OVERLOAD BENCHMARK (4 producers, 1 slow consumer) ---\n");
+    printf("%-22s | %-10s | %-12s\n", "Structure", "Time (s)", "Peak items");
+    printf("-------------------------------------------------------------\n");
+    int peak;
+    double time_unbounded = run_overload_benchmark(0, 4, ops, &peak);
+    printf("%-22s | %-10.4f | %-12d\n", "LFQueue (unbounded)", time_unbounded, peak);
+    double time_bounded = run_overload_benchmark(1, 4, ops, &peak);
+    printf("%-22s | %-10.4f | %-12d\n", "BoundedQueue (1024)", time_bounded, peak);
+
+    // Cross-process hand-off: shared-memory queue vs a Unix socket
+    printf("\n--- SHARED-MEMORY IPC BENCHMARK (2 processes) ---\n");
+    int ipc_items = 200000;
+    double time_socket = run_ipc_benchmark(0, ipc_items);
+    double time_shm = run_ipc_benchmark(1, ipc_items);
+    printf("%-22s | %-10s | %-12s\n", "Transport", "Time (s)", "Mitems/s");
+    printf("-------------------------------------------------------------\n");
+    printf("%-22s | %-10.4f | %-12.2f\n", "Unix socket", time_socket, ipc_items / time_socket / 1e6);
+    printf("%-22s | %-10.4f | %-12.2f\n", "Shared-memory queue", time_shm, ipc_items / time_shm / 1e6);
+
+    // Durable queue: every completed operation is flushed before it returns
+    printf("\n--- DURABLE QUEUE BENCHMARK ---\n");
+    printf("%-22s | %-8s | %-10s | %-12s\n", "Queue", "Threads", "Ops/thread", "Mops/s");
+    printf("-------------------------------------------------------------\n");
+    int durable_threads[] = {1, 4};
+    for (int i = 0; i < 2; i++) {
+        BenchSummary m;
+        run_durable_benchmark("lfq", PERSIST_NONE, durable_threads[i], ops, &m);
+        printf("%-22s | %-8d | %-10d | %-12.2f\n", "LFQueue (volatile)", durable_threads[i], ops, m.median);
+        run_durable_benchmark("durable", PERSIST_FLUSH, durable_threads[i], ops, &m);
+        printf("%-22s | %-8d | %-10d | %-12.2f\n", "Durable (flush)", durable_threads[i], ops, m.median);
+        run_durable_benchmark("durable", PERSIST_MSYNC, durable_threads[i], ops / 50, &m);
+        printf("%-22s | %-8d | %-10d | %-12.2f\n", "Durable (msync)", durable_threads[i], ops / 50, m.median);
+    }
+    int recovery_items = 1000000;
+    printf("Recovery of %d items: %.1f ms\n", recovery_items, run_recovery_benchmark(recovery_items) * 1e3);
+
+    // One producer thread, one consumer: LFQueue against LFQ_DEFINE variants
+    printf("\n--- SPECIALIZED QUEUE BENCHMARK (1 producer, 1 consumer) ---\n");
+    printf("%-22s | %-10s | %-12s\n", "Queue", "Time (s)", "Mitems/s");
+    printf("-------------------------------------------------------------\n");
+    int handoff_items = 1000000;
+    struct {
+        const char *name;
+        double (*run)(int items, size_t capacity);
+    } handoffs[] = {
+        {"LFQueue", handoff_lfq_handoff},
+        {"MPMC unbounded", bench_gen_mpmc_handoff},
+        {"MPSC unbounded", handoff_mpsc_handoff},
+        {"SPSC unbounded", handoff_spsc_handoff},
+        {"MPMC bounded (1024)", bench_gen_ring_handoff},
+        {"SPSC bounded (1024)", handoff_spsc_ring_handoff},
+    };
+    for (int i = 0; i < 6; i++) {
+        double secs = handoffs[i].run(handoff_items, 1024);
+        printf("%-22s | %-10.4f | %-12.2f\n", handoffs[i].name, secs, handoff_items / secs / 1e6);
+    }
+
+    // Logical consumers parked on a channel, all resumed by one executor thread
+    printf("\n--- ASYNC CHANNEL BENCHMARK (4 producer tasks, 1 executor thread) ---\n");
+    printf("%-22s | %-10s | %-12s\n", "Consumer tasks", "Time (s)", "Mitems/s");
+    printf("-------------------------------------------------------------\n");
+    int task_counts[] = {1, 100, 10000};
+    for (int i = 0; i < 3; i++) {
+        double secs = run_channel_tasks(4, task_counts[i], ops, 64);
+        printf("%-22d | %-10.4f | %-12.2f\n", task_counts[i], secs, 4.0 * ops / secs / 1e6);
+    }
+
+    return 0;
+}
@@ -0,0 +1,645 @@
+// harness.c
+// Measurement helpers shared by the benchmark driver and the tests
+
+#define _GNU_SOURCE
+
+#include "harness.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sched.h>
+
+void *xmalloc(size_t size) {
+    void *p = malloc(size);
+    if (!p) {
+        perror("malloc");
+        exit(1);
+    }
+    return p;
+}
+
+// =======================
+// Latency histograms
+// =======================
+
+const double lat_quantiles[] = {0.50, 0.90, 0.99, 0.999, 0.9999, 1.0};
+const char *const lat_quantile_names[] = {"p50", "p90", "p99", "p99.9", "p99.99", "max"};
+
+// Highest value that maps to bucket idx
+uint64_t hist_bucket_upper(int idx) {
+    if (idx < (1 << HIST_SUB_BITS)) return (uint64_t)idx;
+    int half = 1 << (HIST_SUB_BITS - 1);
+    int g = (idx - (1 << HIST_SUB_BITS)) / half + 1;
+    uint64_t sub = (uint64_t)((idx - (1 << HIST_SUB_BITS)) % half + half);
+    return ((sub + 1) << g) - 1;
+}
+
+void hist_merge(LatencyHist *dst, const LatencyHist *src) {
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->total += src->total;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+uint64_t hist_quantile(const LatencyHist *h, double q) {
+    if (h->total == 0) return 0;
+    if (q >= 1.0) return h->max;
+
+    uint64_t rank = (uint64_t)(q * h->total);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint64_t v = hist_bucket_upper(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+// -------- Timestamps ---------------------------
+int lat_timer = TIMER_CLOCK;
+double tsc_ticks_per_ns = 1.0;
+
+// Switches to the TSC; returns 0 if it is unavailable on this architecture
+int lat_use_rdtsc(void) {
+#if HAVE_RDTSC
+    uint64_t c0 = clock_ns();
+    uint64_t t0 = __rdtsc();
+    struct timespec nap = {0, 20000000};
+    nanosleep(&nap, NULL);
+    uint64_t c1 = clock_ns();
+    uint64_t t1 = __rdtsc();
+    tsc_ticks_per_ns = (double)(t1 - t0) / (double)(c1 - c0);
+    lat_timer = TIMER_RDTSC;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+// =======================
+// CPU topology and thread placement
+// =======================
+
+const char *const placement_names[PLACE_NUM] = {
+    "none", "compact", "scatter", "smt-pairs", "one-per-core"
+};
+
+static int read_sysfs_int(int cpu, const char *file, int fallback) {
+    char path[128];
+    int v;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, file);
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return fallback;
+    if (fscanf(f, "%d", &v) != 1) v = fallback;
+    fclose(f);
+    return v;
+}
+
+// Fills smt, core_rank and the core/package counts from cpu, core and package
+void topology_finalize(CpuTopology *t) {
+    t->num_cores = 0;
+    t->num_packages = 0;
+    for (int i = 0; i < t->num_cpus; i++) {
+        CpuInfo *c = &t->cpus[i];
+        int new_package = 1, new_core = 1;
+        c->smt = 0;
+        c->core_rank = 0;
+        for (int j = 0; j < i; j++) {
+            const CpuInfo *o = &t->cpus[j];
+            if (o->package != c->package) continue;
+            new_package = 0;
+            if (o->core == c->core) {
+                new_core = 0;
+                c->smt++;
+                c->core_rank = o->core_rank;
+            }
+        }
+        if (new_core) {
+            for (int j = 0; j < i; j++) {
+                if (t->cpus[j].package == c->package && t->cpus[j].smt == 0) c->core_rank++;
+            }
+            t->num_cores++;
+        }
+        t->num_packages += new_package;
+    }
+}
+
+// Discovers the CPUs in the current affinity mask; returns 1 on success
+int topology_discover(CpuTopology *t) {
+    cpu_set_t allowed;
+    memset(t, 0, sizeof(*t));
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return 0;
+
+    t->cpus = xmalloc(CPU_SETSIZE * sizeof(CpuInfo));
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        CpuInfo *c = &t->cpus[t->num_cpus++];
+        c->cpu = cpu;
+        c->core = read_sysfs_int(cpu, "core_id", cpu);
+        c->package = read_sysfs_int(cpu, "physical_package_id", 0);
+    }
+    topology_finalize(t);
+    return t->num_cpus > 0;
+}
+
+void topology_destroy(CpuTopology *t) {
+    free(t->cpus);
+    t->cpus = NULL;
+    t->num_cpus = 0;
+}
+
+static int placement_strategy;  // Used by placement_cmp (qsort has no context)
+
+static int placement_cmp(const void *a, const void *b) {
+    const CpuInfo *x = a, *y = b;
+    int kx[3], ky[3];
+    switch (placement_strategy) {
+    case PLACE_SCATTER:   // Sibling level, then core, then package varies fastest
+        kx[0] = x->smt; kx[1] = x->core_rank; kx[2] = x->package;
+        ky[0] = y->smt; ky[1] = y->core_rank; ky[2] = y->package;
+        break;
+    case PLACE_SMT_PAIRS: // Package, core, then siblings adjacent
+        kx[0] = x->package; kx[1] = x->core_rank; kx[2] = x->smt;
+        ky[0] = y->package; ky[1] = y->core_rank; ky[2] = y->smt;
+        break;
+    default:              // compact / one-per-core: package, sibling level, core
+        kx[0] = x->package; kx[1] = x->smt; kx[2] = x->core_rank;
+        ky[0] = y->package; ky[1] = y->smt; ky[2] = y->core_rank;
+        break;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (kx[i] != ky[i]) return kx[i] < ky[i] ? -1 : 1;
+    }
+    return x->cpu - y->cpu;
+}
+
+// Writes the CPU for each of num_threads threads into cpus_out; returns how
+// many distinct CPUs the strategy uses (0 for PLACE_NONE)
+int placement_plan(const CpuTopology *t, int strategy, int num_threads, int *cpus_out) {
+    if (strategy == PLACE_NONE || t == NULL || t->num_cpus == 0) {
+        for (int i = 0; i < num_threads; i++) cpus_out[i] = -1;
+        return 0;
+    }
+
+    CpuInfo *order = xmalloc(t->num_cpus * sizeof(CpuInfo));
+    memcpy(order, t->cpus, t->num_cpus * sizeof(CpuInfo));
+    placement_strategy = strategy;
+    qsort(order, t->num_cpus, sizeof(CpuInfo), placement_cmp);
+
+    int n = t->num_cpus;
+    if (strategy == PLACE_ONE_PER_CORE) {
+        n = 0;
+        for (int i = 0; i < t->num_cpus; i++) {
+            if (order[i].smt == 0) order[n++] = order[i];
+        }
+    }
+    for (int i = 0; i < num_threads; i++) {
+        cpus_out[i] = order[i % n].cpu;
+    }
+    free(order);
+    return n < num_threads ? n : num_threads;
+}
+
+// =======================
+// Benchmark statistics
+// =======================
+
+// Two-sided 95% critical values of Student's t for 1..30 degrees of freedom
+static const double t95_table[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+double t95_critical(int df) {
+    if (df < 1) return 0.0;
+    if (df <= 30) return t95_table[df - 1];
+    return df <= 60 ? 2.000 : df <= 120 ? 1.980 : 1.960;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Linear interpolation between closest ranks of an ascending array
+static double sorted_quantile(const double *sorted, int n, double q) {
+    double pos = q * (n - 1);
+    int lo = (int)pos;
+    if (lo + 1 >= n) return sorted[n - 1];
+    return sorted[lo] + (pos - lo) * (sorted[lo + 1] - sorted[lo]);
+}
+
+void bench_summarize(const double *samples, int n, BenchSummary *s) {
+    memset(s, 0, sizeof(*s));
+    if (n <= 0) return;
+
+    double *sorted = xmalloc(n * sizeof(double));
+    memcpy(sorted, samples, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), cmp_double);
+
+    double sum = 0.0, sq = 0.0;
+    for (int i = 0; i < n; i++) sum += sorted[i];
+    s->n = n;
+    s->mean = sum / n;
+    for (int i = 0; i < n; i++) sq += (sorted[i] - s->mean) * (sorted[i] - s->mean);
+    s->stddev = n > 1 ? sqrt(sq / (n - 1)) : 0.0;
+
+    double half = t95_critical(n - 1) * s->stddev / sqrt(n);
+    s->ci95_lo = s->mean - half;
+    s->ci95_hi = s->mean + half;
+
+    s->median = sorted_quantile(sorted, n, 0.5);
+    s->q1 = sorted_quantile(sorted, n, 0.25);
+    s->q3 = sorted_quantile(sorted, n, 0.75);
+    double fence = 1.5 * (s->q3 - s->q1);
+    for (int i = 0; i < n; i++) {
+        if (sorted[i] < s->q1 - fence || sorted[i] > s->q3 + fence) s->outliers++;
+    }
+    free(sorted);
+}
+
+// Welch's unequal-variance t-test. Stores t (positive when b's mean is
+// larger) and the Welch-Satterthwaite degrees of freedom; returns 1 when the
+// means differ at the 5% level, 0 when not, -1 when either side has n < 2.
+int welch_t_test(const double *a, int na, const double *b, int nb, double *t, double *df) {
+    if (na < 2 || nb < 2) return -1;
+    BenchSummary sa, sb;
+    bench_summarize(a, na, &sa);
+    bench_summarize(b, nb, &sb);
+
+    double va = sa.stddev * sa.stddev / na;
+    double vb = sb.stddev * sb.stddev / nb;
+    if (va + vb == 0.0) {
+        // No spread at all: any difference is exact
+        *t = sb.mean == sa.mean ? 0.0 : (sb.mean > sa.mean ? INFINITY : -INFINITY);
+        *df = na + nb - 2;
+        return sb.mean != sa.mean;
+    }
+    *t = (sb.mean - sa.mean) / sqrt(va + vb);
+    *df = (va + vb) * (va + vb) / (va * va / (na - 1) + vb * vb / (nb - 1));
+    return fabs(*t) > t95_critical((int)*df);
+}
+
+// =======================
+// Arrival schedules
+// =======================
+
+const char *const arrival_names[ARRIVAL_NUM] = {"steady", "bursty", "overload", "poisson"};
+
+// Nanoseconds to wait before offering item `seq` (item 0 goes at time 0).
+// Only ARRIVAL_POISSON draws from *seed.
+uint64_t arrival_gap_ns(int pattern, long long seq, double rate, int burst, unsigned *seed) {
+    if (seq == 0 || pattern == ARRIVAL_OVERLOAD || rate <= 0) return 0;
+    double interval = 1e9 / rate;
+    if (pattern == ARRIVAL_BURSTY) {
+        return seq % burst == 0 ? (uint64_t)(interval * burst) : 0;
+    }
+    if (pattern == ARRIVAL_POISSON) {
+        double u = rand_r(seed) / ((double)RAND_MAX + 1.0);
+        return (uint64_t)(-log(1.0 - u) * interval);
+    }
+    return (uint64_t)interval;
+}
+
+// Open-loop schedule: intended send time of each of n items, in ns from the
+// start of the run. Computed before timing starts so the producer never
+// derives the next send time from when the previous operation finished.
+uint64_t *arrival_schedule(int pattern, long long n, double rate, int burst, unsigned seed) {
+    uint64_t *at = xmalloc((n > 0 ? n : 1) * sizeof(uint64_t));
+    uint64_t t = 0;
+    for (long long seq = 0; seq < n; seq++) {
+        t += arrival_gap_ns(pattern, seq, rate, burst, &seed);
+        at[seq] = t;
+    }
+    return at;
+}
+
+// Waits until clock_ns() reaches target: sleeps through long gaps, yields
+// through the last stretch so a shared CPU is not monopolised
+void wait_until_ns(uint64_t target) {
+    uint64_t now = clock_ns();
+    while (now < target) {
+        if (target - now > 200000) {
+            struct timespec nap = {0, (long)(target - now - 100000)};
+            nanosleep(&nap, NULL);
+        } else {
+            sched_yield();
+        }
+        now = clock_ns();
+    }
+}
+
+// =======================
+// Linearizability histories
+// =======================
+
+const char *const lin_violation_names[LIN_NUM] = {
+    "linearizable", "duplicate enqueue", "fresh", "repeat", "order", "empty"};
+
+void lin_log_init(LinLog *log, size_t capacity) {
+    log->capacity = capacity > 0 ? capacity : 1;
+    log->events = xmalloc(log->capacity * sizeof(LinEvent));
+    log->count = 0;
+}
+
+void lin_log_free(LinLog *log) {
+    free(log->events);
+    log->events = NULL;
+    log->count = 0;
+    log->capacity = 0;
+}
+
+void lin_log_grow(LinLog *log) {
+    log->capacity *= 2;
+    log->events = realloc(log->events, log->capacity * sizeof(LinEvent));
+    if (!log->events) {
+        perror("realloc");
+        exit(1);
+    }
+}
+
+// One enqueued value with its matching dequeue; deq_invoke is UINT64_MAX
+// for a value that never came out, so it sorts after every real dequeue
+typedef struct {
+    int value;
+    int dequeued;
+    uint64_t enq_invoke, enq_response;
+    uint64_t deq_invoke, deq_response;
+} LinItem;
+
+typedef struct {
+    uint64_t start, end;
+    int value;
+} LinSpan;
+
+static int lin_cmp_event_value(const void *a, const void *b) {
+    int x = ((const LinEvent *)a)->value, y = ((const LinEvent *)b)->value;
+    return (x > y) - (x < y);
+}
+
+static int lin_cmp_item_enq_response(const void *a, const void *b) {
+    uint64_t x = ((const LinItem *)a)->enq_response, y = ((const LinItem *)b)->enq_response;
+    return (x > y) - (x < y);
+}
+
+static int lin_cmp_item_enq_invoke(const void *a, const void *b) {
+    uint64_t x = ((const LinItem *)a)->enq_invoke, y = ((const LinItem *)b)->enq_invoke;
+    return (x > y) - (x < y);
+}
+
+static int lin_cmp_span_start(const void *a, const void *b) {
+    uint64_t x = ((const LinSpan *)a)->start, y = ((const LinSpan *)b)->start;
+    return (x > y) - (x < y);
+}
+
+static int lin_fail(LinReport *r, int violation, int value, int other) {
+    r->violation = violation;
+    r->value = value;
+    r->other = other;
+    return 0;
+}
+
+static int lin_check_sorted(LinEvent *enq, size_t ne, LinEvent *deq, size_t nd,
+                            LinEvent *empty, size_t nempty, LinItem *items, LinReport *r) {
+    qsort(enq, ne, sizeof(LinEvent), lin_cmp_event_value);
+    qsort(deq, nd, sizeof(LinEvent), lin_cmp_event_value);
+    for (size_t i = 1; i < ne; i++) {
+        if (enq[i].value == enq[i - 1].value) return lin_fail(r, LIN_DUPLICATE, enq[i].value, 0);
+    }
+    for (size_t i = 1; i < nd; i++) {
+        if (deq[i].value == deq[i - 1].value) return lin_fail(r, LIN_REPEAT, deq[i].value, 0);
+    }
+
+    // Pair each dequeue with its enqueue: both lists are sorted by value
+    size_t d = 0;
+    for (size_t i = 0; i < ne; i++) {
+        if (d < nd && deq[d].value < enq[i].value) return lin_fail(r, LIN_FRESH, deq[d].value, 0);
+        LinItem *it = &items[i];
+        *it = (LinItem){enq[i].value, 0, enq[i].invoke, enq[i].response, UINT64_MAX, UINT64_MAX};
+        if (d < nd && deq[d].value == enq[i].value) {
+            if (deq[d].response < enq[i].invoke) return lin_fail(r, LIN_FRESH, deq[d].value, 0);
+            it->dequeued = 1;
+            it->deq_invoke = deq[d].invoke;
+            it->deq_response = deq[d].response;
+            d++;
+        }
+    }
+    if (d < nd) return lin_fail(r, LIN_FRESH, deq[d].value, 0);
+
+    // Order: sweep the items by enqueue start; every item whose enqueue
+    // finished before that start must not be dequeued after this one was
+    LinItem *by_resp = xmalloc((ne > 0 ? ne : 1) * sizeof(LinItem));
+    memcpy(by_resp, items, ne * sizeof(LinItem));
+    qsort(by_resp, ne, sizeof(LinItem), lin_cmp_item_enq_response);
+    qsort(items, ne, sizeof(LinItem), lin_cmp_item_enq_invoke);
+    uint64_t latest = 0;
+    int latest_value = 0;
+    size_t a = 0;
+    int ok = 1;
+    for (size_t i = 0; i < ne && ok; i++) {
+        while (a < ne && by_resp[a].enq_response < items[i].enq_invoke) {
+            if (by_resp[a].deq_invoke >= latest) {
+                latest = by_resp[a].deq_invoke;
+                latest_value = by_resp[a].value;
+            }
+            a++;
+        }
+        if (items[i].dequeued && a > 0 && latest > items[i].deq_response) {
+            ok = lin_fail(r, LIN_ORDER, items[i].value, latest_value);
+        }
+    }
+    free(by_resp);
+    if (!ok) return 0;
+
+    // Empty: merge the spans during which each item is certainly in the
+    // queue, then look for one that covers an empty dequeue
+    LinSpan *spans = xmalloc((ne > 0 ? ne : 1) * sizeof(LinSpan));
+    size_t ns = 0;
+    for (size_t i = 0; i < ne; i++) {
+        if (items[i].enq_response < items[i].deq_invoke) {
+            spans[ns++] = (LinSpan){items[i].enq_response, items[i].deq_invoke, items[i].value};
+        }
+    }
+    qsort(spans, ns, sizeof(LinSpan), lin_cmp_span_start);
+    size_t merged = 0;
+    for (size_t i = 0; i < ns; i++) {
+        // The spans are open, so two that only touch leave an empty instant
+        if (merged > 0 && spans[i].start < spans[merged - 1].end) {
+            if (spans[i].end > spans[merged - 1].end) spans[merged - 1].end = spans[i].end;
+        } else {
+            spans[merged++] = spans[i];
+        }
+    }
+    for (size_t e = 0; e < nempty && ok; e++) {
+        // Last merged span starting before the dequeue did
+        size_t lo = 0, hi = merged;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (spans[mid].start < empty[e].invoke) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo > 0 && spans[lo - 1].end > empty[e].response) {
+            ok = lin_fail(r, LIN_EMPTY, spans[lo - 1].value, 0);
+        }
+    }
+    free(spans);
+    return ok;
+}
+
+int lin_check_fifo(const LinLog *logs, int num_logs, LinReport *report) {
+    LinReport local;
+    LinReport *r = report ? report : &local;
+    memset(r, 0, sizeof(*r));
+
+    size_t total = 0;
+    for (int i = 0; i < num_logs; i++) total += logs[i].count;
+    LinEvent *enq = xmalloc((total > 0 ? total : 1) * sizeof(LinEvent));
+    LinEvent *deq = xmalloc((total > 0 ? total : 1) * sizeof(LinEvent));
+    LinEvent *empty = xmalloc((total > 0 ? total : 1) * sizeof(LinEvent));
+    size_t ne = 0, nd = 0, nempty = 0;
+    for (int i = 0; i < num_logs; i++) {
+        for (size_t k = 0; k < logs[i].count; k++) {
+            const LinEvent *ev = &logs[i].events[k];
+            if (ev->op == LIN_ENQ) {
+                if (ev->ok) enq[ne++] = *ev;
+            } else if (ev->ok) {
+                deq[nd++] = *ev;
+            } else {
+                empty[nempty++] = *ev;
+            }
+        }
+    }
+    r->enqueues = ne;
+    r->dequeues = nd;
+    r->empty_dequeues = nempty;
+
+    LinItem *items = xmalloc((ne > 0 ? ne : 1) * sizeof(LinItem));
+    int ok = lin_check_sorted(enq, ne, deq, nd, empty, nempty, items, r);
+    free(items);
+    free(enq);
+    free(deq);
+    free(empty);
+    return ok;
+}
+
+// =======================
+// Multicast ring workers
+// =======================
+
+void *ring_producer_thread(void *arg) {
+    RingArgs *args = (RingArgs *)arg;
+    for (int i = 0; i < args->count; i++) {
+        ring_publish_value(args->r, args->id * args->count + i);
+    }
+    return NULL;
+}
+
+void *ring_consumer_thread(void *arg) {
+    RingArgs *args = (RingArgs *)arg;
+    RingConsumer *c = &args->r->consumers[args->id];
+    int64_t next = 0;
+
+    while (next < args->count) {
+        int64_t avail = ring_wait_for(args->r, args->id, next);
+        for (int64_t seq = next; seq <= avail; seq++) {
+            args->sum += *ring_slot(args->r, seq);
+        }
+        // A dependent consumer must never run ahead of its upstream
+        for (int i = 0; i < c->num_deps; i++) {
+            if (atomic_load(&args->r->consumers[c->deps[i]].seq) < avail) args->ok = 0;
+        }
+        ring_release(args->r, args->id, avail);
+        next = avail + 1;
+    }
+    return NULL;
+}
+
+// =======================
+// Async channel tasks
+// =======================
+
+static void chan_consumer_resume(ChanWaiter *w) {
+    ChanTask *t = (ChanTask *)w;
+    t->sum += w->value;
+    t->count++;
+    chan_consumer_run(t);
+}
+
+void chan_consumer_run(ChanTask *t) {
+    int value;
+    while (t->count < t->target) {
+        if (!chan_pop_async(t->ch, &value, &t->w, chan_consumer_resume)) return; // Suspended
+        t->sum += value;
+        t->count++;
+    }
+    atomic_fetch_add(t->finished, 1);
+}
+
+static void chan_producer_resume(ChanWaiter *w) {
+    ChanTask *t = (ChanTask *)w;
+    t->count++;
+    chan_producer_run(t);
+}
+
+void chan_producer_run(ChanTask *t) {
+    while (t->count < t->target) {
+        if (!chan_push_async(t->ch, t->first + t->count, &t->w, chan_producer_resume)) return;
+        t->count++;
+    }
+    atomic_fetch_add(t->finished, 1);
+}
+
+// Runs producers x per_producer items through a channel of the given
+// capacity into consumers tasks, all resumed on one executor thread.
+// Returns the seconds taken, or -1 if the tasks did not all finish or the
+// item sum is wrong.
+double run_channel_tasks(int producers, int consumers, int per_producer, size_t capacity) {
+    ChanExecutor exec;
+    AsyncChannel ch;
+    _Atomic(int) finished = 0;
+    int total = producers * per_producer;
+    ChanTask *tasks = xmalloc((producers + consumers) * sizeof(ChanTask));
+
+    chan_executor_start(&exec);
+    chan_init(&ch, capacity, &exec);
+    for (int i = 0; i < producers + consumers; i++) {
+        int is_producer = i < producers;
+        tasks[i] = (ChanTask){.ch = &ch, .finished = &finished};
+        tasks[i].first = is_producer ? i * per_producer : 0;
+        tasks[i].target = is_producer ? per_producer
+                                      : total / consumers + (i - producers < total % consumers);
+    }
+
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = producers; i < producers + consumers; i++) {
+        chan_consumer_run(&tasks[i]);
+    }
+    for (int i = 0; i < producers; i++) {
+        chan_producer_run(&tasks[i]);
+    }
+    double seconds;
+    do {
+        sched_yield();
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        seconds = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+    } while (atomic_load(&finished) < producers + consumers && seconds < 10);
+
+    chan_executor_stop(&exec);
+    long long sum = 0;
+    for (int i = producers; i < producers + consumers; i++) {
+        sum += tasks[i].sum;
+    }
+    if (atomic_load(&finished) < producers + consumers || sum != (long long)total * (total - 1) / 2) {
+        seconds = -1;
+    }
+    chan_destroy(&ch);
+    free(tasks);
+    return seconds;
+}
@@ -0,0 +1,265 @@
+// harness.h
+// Measurement helpers shared by the benchmark driver and the tests: latency
+// histograms, timestamps, CPU placement, run statistics, arrival schedules
+// and the async channel task harness.
+
+#ifndef LFQ_HARNESS_H
+#define LFQ_HARNESS_H
+
+#include "lfq.h"
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+
+// Checked malloc for harness-side buffers that are not queue memory
+void *xmalloc(size_t size);
+
+// =======================
+// Latency histograms
+// =======================
+
+// Log-linear buckets in the style of HdrHistogram: values below 2^HIST_SUB_BITS
+// are exact, every larger power of two is split into 2^(HIST_SUB_BITS-1)
+// equal buckets, so the relative error stays under 2^-(HIST_SUB_BITS-1).
+#define HIST_SUB_BITS 6
+#define HIST_BUCKETS ((1 << HIST_SUB_BITS) + (64 - HIST_SUB_BITS) * (1 << (HIST_SUB_BITS - 1)))
+
+typedef struct {
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t max;
+} LatencyHist;
+
+// Quantiles reported for every histogram; the last entry is the maximum
+extern const double lat_quantiles[];
+extern const char *const lat_quantile_names[];
+#define LAT_NUM_QUANTILES 6
+#define LAT_P99 2  // Index of p99 in lat_quantiles
+
+static inline int hist_index(uint64_t v) {
+    if (v < (1u << HIST_SUB_BITS)) return (int)v;
+    int msb = 63 - __builtin_clzll(v);
+    int g = msb - HIST_SUB_BITS + 1;
+    int half = 1 << (HIST_SUB_BITS - 1);
+    return (1 << HIST_SUB_BITS) + (g - 1) * half + (int)((v >> g) - half);
+}
+
+static inline void hist_record(LatencyHist *h, uint64_t v) {
+    h->counts[hist_index(v)]++;
+    h->total++;
+    if (v > h->max) h->max = v;
+}
+
+// Highest value that maps to bucket idx
+uint64_t hist_bucket_upper(int idx);
+void hist_merge(LatencyHist *dst, const LatencyHist *src);
+uint64_t hist_quantile(const LatencyHist *h, double q);
+
+// -------- Timestamps ---------------------------
+// CLOCK_MONOTONIC_RAW by default; on x86 the TSC can be used instead and is
+// converted to nanoseconds with a one-off calibration against the raw clock.
+enum { TIMER_CLOCK, TIMER_RDTSC };
+
+extern int lat_timer;
+extern double tsc_ticks_per_ns;
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_RDTSC 1
+#else
+#define HAVE_RDTSC 0
+#endif
+
+static inline uint64_t clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Raw timer reading: nanoseconds, or TSC ticks when TIMER_RDTSC is active
+static inline uint64_t lat_now(void) {
+#if HAVE_RDTSC
+    if (lat_timer == TIMER_RDTSC) return __rdtsc();
+#endif
+    return clock_ns();
+}
+
+static inline uint64_t lat_to_ns(uint64_t ticks) {
+    return lat_timer == TIMER_RDTSC ? (uint64_t)(ticks / tsc_ticks_per_ns) : ticks;
+}
+
+// Switches to the TSC; returns 0 if it is unavailable on this architecture
+int lat_use_rdtsc(void);
+
+// =======================
+// CPU topology and thread placement
+// =======================
+
+// Topology comes from /sys/devices/system/cpu/cpuN/topology, restricted to
+// the CPUs this process may run on. A placement strategy turns it into an
+// ordered CPU list and bench thread i is pinned to entry i (mod length).
+//   compact      fill one package, one thread per core before SMT siblings
+//   scatter      round-robin across packages, then cores, then siblings
+//   smt-pairs    consecutive threads share a core (siblings first)
+//   one-per-core first SMT thread of every core only
+enum { PLACE_NONE, PLACE_COMPACT, PLACE_SCATTER, PLACE_SMT_PAIRS, PLACE_ONE_PER_CORE, PLACE_NUM };
+
+extern const char *const placement_names[PLACE_NUM];
+
+typedef struct {
+    int cpu;
+    int core;     // core_id, unique only within a package
+    int package;  // physical_package_id
+    int smt;      // Index among the core's hardware threads
+    int core_rank;  // Index of the core within its package
+} CpuInfo;
+
+typedef struct {
+    CpuInfo *cpus;
+    int num_cpus;
+    int num_cores;
+    int num_packages;
+} CpuTopology;
+
+int topology_discover(CpuTopology *t);
+void topology_finalize(CpuTopology *t);
+void topology_destroy(CpuTopology *t);
+int placement_plan(const CpuTopology *t, int strategy, int num_threads, int *cpus_out);
+
+// =======================
+// Benchmark statistics
+// =======================
+
+// Summary of repeated measurements of one configuration. Outliers use
+// Tukey's fences (more than 1.5 IQR outside the quartiles); they are counted,
+// not dropped, since the median is already robust to them.
+typedef struct {
+    int n;
+    double mean;
+    double median;
+    double stddev;      // Sample standard deviation (n - 1)
+    double ci95_lo;     // 95% confidence interval of the mean (Student's t)
+    double ci95_hi;
+    double q1, q3;
+    int outliers;
+} BenchSummary;
+
+double t95_critical(int df);
+void bench_summarize(const double *samples, int n, BenchSummary *s);
+int welch_t_test(const double *a, int na, const double *b, int nb, double *t, double *df);
+
+// =======================
+// Arrival schedules
+// =======================
+
+// Gaps between the items a paced producer offers, for pipeline benchmarks.
+//   steady    one item every 1/rate seconds ("constant" in open-loop mode)
+//   bursty    `burst` items back to back, then idle so the mean rate is kept
+//   overload  no pacing at all: producers run flat out, faster than consumers
+//   poisson   exponentially distributed gaps with mean 1/rate
+enum { ARRIVAL_STEADY, ARRIVAL_BURSTY, ARRIVAL_OVERLOAD, ARRIVAL_POISSON, ARRIVAL_NUM };
+
+extern const char *const arrival_names[ARRIVAL_NUM];
+
+uint64_t arrival_gap_ns(int pattern, long long seq, double rate, int burst, unsigned *seed);
+uint64_t *arrival_schedule(int pattern, long long n, double rate, int burst, unsigned seed);
+void wait_until_ns(uint64_t target);
+
+// =======================
+// Linearizability histories
+// =======================
+// Each thread logs its queue operations with the clock_ns() time before the
+// call and after it returned. lin_check_fifo then searches the history
+// offline, in O(n log n), for the violation patterns of Henzinger, Sezgin and
+// Vafeiadis (CONCUR 2013). Enqueued values must be unique within a history.
+//   fresh   a value is dequeued that was never enqueued, or before its enqueue began
+//   repeat  a value is dequeued twice
+//   order   a was enqueued before b began, but b was dequeued before a's
+//           dequeue began (or a never came out)
+//   empty   a dequeue returned empty while some item was in the queue for its
+//           whole duration
+// The empty test is one-sided. It covers the dequeue with the union of the
+// spans in which items are certainly queued (enqueue response to dequeue
+// invocation), so it misses an empty result that is only wrong for some
+// placements of overlapping operations. Empty is checked last, so LIN_EMPTY
+// means no other pattern was found; callers that accept weaker empty results
+// (bq_dequeue) rely on that.
+enum { LIN_ENQ, LIN_DEQ };
+enum { LIN_OK, LIN_DUPLICATE, LIN_FRESH, LIN_REPEAT, LIN_ORDER, LIN_EMPTY, LIN_NUM };
+
+extern const char *const lin_violation_names[LIN_NUM];
+
+typedef struct {
+    uint64_t invoke;
+    uint64_t response;
+    int value;            // Enqueued or dequeued value; unused for a failed call
+    unsigned char op;     // LIN_ENQ or LIN_DEQ
+    unsigned char ok;     // 0: the enqueue found the queue full / the dequeue found it empty
+} LinEvent;
+
+// One per thread, so recording never synchronizes
+typedef struct {
+    LinEvent *events;
+    size_t count;
+    size_t capacity;
+} LinLog;
+
+typedef struct {
+    int violation;        // LIN_OK, or the first pattern found
+    int value;            // The value involved (the empty dequeue's witness for LIN_EMPTY)
+    int other;            // LIN_ORDER: the value that should have come out first
+    size_t enqueues;
+    size_t dequeues;
+    size_t empty_dequeues;
+} LinReport;
+
+void lin_log_init(LinLog *log, size_t capacity);
+void lin_log_free(LinLog *log);
+void lin_log_grow(LinLog *log);
+
+static inline void lin_record(LinLog *log, int op, int value, int ok,
+                              uint64_t invoke, uint64_t response) {
+    if (log->count == log->capacity) lin_log_grow(log);
+    log->events[log->count++] = (LinEvent){invoke, response, value, (unsigned char)op, (unsigned char)ok};
+}
+
+// 1 if none of the patterns above occurs in the history; report may be NULL
+int lin_check_fifo(const LinLog *logs, int num_logs, LinReport *report);
+
+// =======================
+// Multicast ring workers
+// =======================
+// Producer publishes count events starting at id * count; consumer id reads
+// count events in place, sums them and checks it never passes its upstream.
+typedef struct {
+    MulticastRing *r;
+    int id;            // Producer index or consumer id
+    int count;         // Events per producer / total events
+    long long sum;
+    int ok;
+} RingArgs;
+
+void *ring_producer_thread(void *arg);
+void *ring_consumer_thread(void *arg);
+
+// =======================
+// Async channel tasks
+// =======================
+// Each task is a hand-written coroutine: run loops until an operation parks,
+// and the waiter's callback records the result and re-enters run.
+typedef struct {
+    ChanWaiter w;         // First member, so the waiter converts back to the task
+    AsyncChannel *ch;
+    int first;            // Producers push first .. first + target - 1
+    int target;
+    int count;
+    long long sum;
+    _Atomic(int) *finished;
+} ChanTask;
+
+void chan_consumer_run(ChanTask *t);
+void chan_producer_run(ChanTask *t);
+double run_channel_tasks(int producers, int consumers, int per_producer, size_t capacity);
+
+#endif // LFQ_HARNESS_H
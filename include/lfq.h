@@ -0,0 +1,489 @@
+// lfq.h
+// Public interface of liblfq: the Michael & Scott lock-free queue and the
+// structures built around it, deferred reclamation, memory telemetry and
+// the optional CAS statistics. Link with -llfq -pthread.
+
+#ifndef LFQ_H
+#define LFQ_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// =======================
+// Data structures
+// =======================
+
+typedef struct Node {
+    int value;
+    uint64_t stamp;     // Enqueue time, used by the relaxed MultiQueue
+    _Atomic(struct Node *) next;
+} Node;
+
+// -------- Lock-free queue (Michael & Scott) -----
+typedef struct {
+    _Atomic(Node *) head;
+    _Atomic(Node *) tail;
+    _Atomic(int) size; // For tracking (not part of original algorithm)
+    _Atomic(int) armed; // A consumer is waiting on notify_fd for the next item
+    int notify_fd;      // eventfd from lfqueue_notify_fd, -1 until requested
+} LFQueue;
+
+// -------- Lock-based queue (Mutex) --------------
+typedef struct {
+    Node *head;
+    Node *tail;
+    pthread_mutex_t lock;
+    int size;
+} LockedQueue;
+
+// -------- Relaxed sharded queue (MultiQueue) ----
+// Items are spread over num_shards LFQueues. Each enqueue stamps its node
+// with the enqueuing thread's clock (TSC on x86) and picks a random shard;
+// dequeue takes the older front of two random shards. There is no shared
+// counter, so enqueuers on different shards touch no common cache line.
+//
+// num_shards is the relaxation bound. With k shards and two choices a
+// dequeue returns, in expectation, an item of rank O(k) among those in the
+// queue, and the worst rank over n dequeues is O(k log n) with high
+// probability (Alistarh et al., PODC 2017). A single shard is strict FIFO.
+// In practice the mean rank error is about k, so pick k for the error you
+// can accept, then as many shards per thread as keeps CAS contention low.
+typedef struct {
+    LFQueue *shards;
+    int num_shards;
+} MultiQueue;
+
+// -------- Lock-free priority queue (Linden & Jonsson skiplist) -----
+// deletemin only sets the mark bit in the predecessor's next[0], so deleted
+// nodes form a prefix of the list. The prefix is physically unlinked in one
+// batch once it grows past PQ_BOUND_OFFSET nodes.
+#define PQ_MAX_LEVEL 16
+#define PQ_BOUND_OFFSET 32
+
+typedef struct PQNode {
+    int key;
+    int value;
+    int level;
+    _Atomic(int) inserting;     // Upper levels still being linked
+    _Atomic(uintptr_t) next[];  // Bit 0 of next[0]: successor is deleted
+} PQNode;
+
+typedef struct {
+    PQNode *head;
+    PQNode *tail;
+    _Atomic(int) size;
+} LFPriorityQueue;
+
+// -------- Lock-free stack (Treiber + elimination) -----
+// A push that loses the CAS on top parks its node in a random elimination
+// slot for a short while; a pop that loses the CAS tries to grab a parked
+// node instead. Matched pairs complete without touching top.
+#define ELIM_SLOTS 8
+#define ELIM_SPINS 64
+
+typedef struct {
+    _Atomic(Node *) offer;
+    char pad[64 - sizeof(Node *)]; // Keep slots on separate cache lines
+} EliminationSlot;
+
+typedef struct {
+    _Atomic(Node *) top;
+    _Atomic(int) size;
+    int use_elimination;
+    EliminationSlot elim[ELIM_SLOTS];
+} LFStack;
+
+// -------- Multicast ring (Disruptor-style) -----
+// Every event is written once into a preallocated slot and read in place by
+// all consumers. Each consumer advances its own cursor; a consumer's barrier
+// is the published cursor plus the cursors of the consumers it depends on,
+// and producers are gated by the slowest consumer.
+#define RING_MAX_CONSUMERS 8
+#define RING_MAX_DEPS 4
+
+typedef struct {
+    _Atomic(int64_t) seq; // Last sequence this consumer has finished with
+    int deps[RING_MAX_DEPS];
+    int num_deps;
+    char pad[64 - sizeof(int64_t) - (RING_MAX_DEPS + 1) * sizeof(int)];
+} RingConsumer;
+
+typedef struct {
+    int *slots;
+    int64_t capacity;              // Power of two
+    int64_t mask;
+    int shift;                     // log2(capacity), for lap numbers
+    int multi_producer;
+    int64_t next_claim;            // Single-producer claim counter
+    _Atomic(int64_t) claim;        // Multi-producer claim counter
+    _Atomic(int64_t) cursor;       // Highest published sequence (single-producer)
+    _Atomic(int32_t) *published;   // Lap of the last publish per slot (multi-producer)
+    _Atomic(int64_t) gate_cache;   // Last computed minimum consumer sequence
+    int num_consumers;
+    RingConsumer consumers[RING_MAX_CONSUMERS];
+} MulticastRing;
+
+// -------- Bounded queue (Vyukov MPMC ring) -----
+// Fixed array of slots, each tagged with the position it expects next, so
+// memory stays flat no matter how far producers outrun consumers. Producers
+// that want to wait for space sleep on a condition variable; consumers only
+// touch the mutex when a waiter is registered.
+typedef struct {
+    _Atomic(size_t) seq;
+    int value;
+} BQSlot;
+
+typedef struct {
+    BQSlot *slots;
+    size_t capacity;              // Power of two
+    size_t mask;
+    char pad0[64];
+    _Atomic(size_t) enq_pos;
+    char pad1[64];
+    _Atomic(size_t) deq_pos;
+    char pad2[64];
+    _Atomic(int) waiters;         // Producers blocked waiting for space
+    pthread_mutex_t wait_lock;
+    pthread_cond_t not_full;
+} BoundedQueue;
+
+// Slots claimed by bq_try_reserve, filled in place and published by bq_commit
+typedef struct {
+    size_t start;
+    int count;
+} BQReservation;
+
+// -------- Shared-memory queue (offset-based Michael & Scott) -----
+// The queue and its node pool live in one shm_open region that each process
+// maps at its own address, so links are node indices into the pool instead of
+// pointers. Every link carries a modification counter in its upper 32 bits
+// (the counted pointers of the original M&S paper): dequeued nodes go straight
+// back to the in-region free list, and the counter stops a stale CAS from
+// succeeding on a recycled node.
+#define SHM_MAGIC 0x4c465153u // "LFQS"
+#define SHM_MAX_PARTICIPANTS 16
+
+typedef struct {
+    int value;
+    _Atomic(uint64_t) next;       // Tagged index of the successor (0 = none)
+    _Atomic(uint32_t) free_next;  // Free-list link
+} ShmNode;
+
+typedef struct {
+    _Atomic(uint32_t) magic;      // Stored last by the creating process
+    uint32_t capacity;            // Items the pool can hold (one more node is the dummy)
+    char pad0[64];
+    _Atomic(uint64_t) head;
+    char pad1[64];
+    _Atomic(uint64_t) tail;
+    char pad2[64];
+    _Atomic(uint64_t) free_top;   // Tagged index of the first free node
+    _Atomic(int) size;
+    _Atomic(int) recovering;      // A sweep is running; attaching processes wait
+    _Atomic(int) participants[SHM_MAX_PARTICIPANTS]; // pid per slot, 0 = unused
+    ShmNode nodes[];              // nodes[0] is never used, index 0 means null
+} ShmRegion;
+
+// Per-process handle to a mapped region
+typedef struct {
+    ShmRegion *r;
+    size_t map_size;
+    int slot;                     // This process's participant slot
+} ShmQueue;
+
+// -------- Durable queue (file-backed ShmRegion) -----
+// Same region and offset pool, mapped from an ordinary file. Every store a
+// later operation depends on is flushed first, so after a crash the chain
+// from the durable head is exactly the completed operations and recovery
+// only has to rebuild the volatile parts (tail, size, free list).
+#define DQ_MAGIC 0x4c465144u // "LFQD"
+
+enum { PERSIST_NONE, PERSIST_FLUSH, PERSIST_MSYNC, PERSIST_NUM };
+extern const char *const persist_names[PERSIST_NUM];
+
+typedef struct {
+    ShmRegion *r;
+    size_t map_size;
+    int persist;                  // PERSIST_FLUSH or PERSIST_MSYNC
+    int recovered_items;          // Items found in the file by dq_open
+} DurableQueue;
+
+// -------- Async channel (callback continuations over BoundedQueue) -----
+// pop and push either complete at once or park a waiter and complete later
+// by calling its callback, on the thread that made progress possible or on
+// an executor thread. A waiter is the continuation of a suspended task, so
+// many logical consumers can share a few OS threads. Parking pushes onto a
+// lock-free inbox (push and take-all only, so no ABA); whichever thread wins
+// the dispatch counter moves inboxes into private FIFOs and pairs waiters
+// with items or free slots, and other threads only bump the counter.
+typedef struct ChanWaiter {
+    struct ChanWaiter *next;
+    void (*resume)(struct ChanWaiter *w); // Embed the waiter first in the task
+    int value;                            // Item to push, or the item popped
+    int status;                           // LFQ_OK, or LFQ_CLOSED if chan_destroy resumed it
+} ChanWaiter;
+
+typedef struct {
+    _Atomic(ChanWaiter *) ready;  // Continuations waiting to run
+    _Atomic(int) sleeping;
+    _Atomic(int) stop;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_t thread;
+} ChanExecutor;
+
+typedef struct {
+    BoundedQueue q;
+    _Atomic(ChanWaiter *) pop_inbox;
+    _Atomic(ChanWaiter *) push_inbox;
+    _Atomic(int) pop_parked;      // Waiters in the inbox or FIFO, per side
+    _Atomic(int) push_parked;
+    _Atomic(int) dispatch;        // Requests since the dispatcher last looked
+    ChanWaiter *pop_head, *pop_tail;   // FIFOs owned by the running dispatcher
+    ChanWaiter *push_head, *push_tail;
+    ChanExecutor *exec;           // NULL resumes waiters inline
+} AsyncChannel;
+
+// -------- Lock-based priority queue (Mutex + binary heap) -----
+typedef struct {
+    int *keys;
+    int *values;
+    int size;
+    int capacity;
+    pthread_mutex_t lock;
+} LockedPQ;
+
+// -------- Retired nodes list for deferred reclamation -----
+#define MAX_RETIRED 1000
+typedef struct {
+    void *nodes[MAX_RETIRED];
+    int count;
+    int peak;             // Highest count since the last mem_stats_reset
+    long long total;      // Nodes ever retired
+    long long dropped;    // Retired while full: never freed (leaked)
+    pthread_mutex_t lock;
+} RetiredList;
+
+extern RetiredList retired_list;
+
+// =======================
+// Memory telemetry
+// =======================
+
+typedef struct {
+    long long alloc_calls;
+    long long free_calls;
+    long long live_allocs;   // Allocations not yet freed (mostly nodes)
+    long long live_bytes;    // Usable bytes of those allocations
+    int retired;             // Nodes waiting in the retired list
+    int peak_retired;
+    long long retired_total;
+    long long dropped;       // Retired past MAX_RETIRED and leaked
+    long rss_kb;             // Current resident set size (0 if unknown)
+    long peak_rss_kb;        // Process high-water mark (getrusage)
+} MemStats;
+
+// =======================
+// Lock-free operation statistics
+// =======================
+// Counted only in a library built with LFQ_STATS; otherwise snapshots are all
+// zero. LFQ_STATS_ENABLED tells callers which one they linked against.
+
+enum {
+    LFQ_OP_ENQUEUE, LFQ_OP_DEQUEUE,         // LFQueue (and MultiQueue shards)
+    LFQ_OP_PUSH, LFQ_OP_POP,                // LFStack
+    LFQ_OP_PQ_INSERT, LFQ_OP_PQ_DELETE_MIN, // LFPriorityQueue
+    LFQ_OP_BQ_RESERVE, LFQ_OP_BQ_DEQUEUE,   // BoundedQueue
+    LFQ_NUM_OPS
+};
+
+// Retry histogram buckets: 0, 1, 2-3, 4-7, 8-15, 16-31, 32-63, 64+
+#define LFQ_RETRY_BUCKETS 8
+
+typedef struct {
+    uint64_t ops;
+    uint64_t cas_attempts;
+    uint64_t cas_failures;
+    uint64_t tail_helps;      // Lagging tail swung forward for another thread
+    uint64_t empty_returns;
+    uint64_t retries[LFQ_RETRY_BUCKETS];
+} LFQOpStats;
+
+typedef struct {
+    LFQOpStats op[LFQ_NUM_OPS];
+} LFQStats;
+
+#ifdef LFQ_STATS
+#define LFQ_STATS_ENABLED 1
+#else
+#define LFQ_STATS_ENABLED 0
+#endif
+
+// Result of lfqueue_try_dequeue
+enum { LFQ_CLOSED = -1, LFQ_EMPTY = 0, LFQ_OK = 1 };
+
+// =======================
+// Deterministic scheduler
+// =======================
+// Runs a handful of threads one at a time and switches between them only at
+// the LFQ_* atomic operations of lfq_atomic.h, so a run is reproducible from
+// its configuration. Switching needs the queue code compiled with LFQ_SCHED;
+// elsewhere each thread runs to completion in turn. Memory is sequentially
+// consistent between switches, so this explores interleavings, not weak
+// orderings (see LFQ_TSAN for those). Thread bodies must finish on their own:
+// a thread that waits for another one never gives up its turn under PCT.
+
+typedef enum {
+    LFQ_SCHED_RANDOM,   // Uniform choice among runnable threads at every step
+    LFQ_SCHED_PCT,      // Probabilistic concurrency testing (Burckhardt et al.)
+    LFQ_SCHED_DFS,      // Every schedule within a preemption bound, in order
+} LFQSchedStrategy;
+
+typedef struct {
+    LFQSchedStrategy strategy;
+    unsigned int seed;      // RANDOM, PCT; lfq_sched_next increments it
+    int depth;              // PCT: bug depth, i.e. depth - 1 priority change points
+    long max_steps;         // PCT: change points are drawn from [1, max_steps]
+    int preemptions;        // DFS: switches away from a runnable thread per run
+    // DFS position, kept between runs. Zero-initialize; lfq_sched_free releases it.
+    int *choice;
+    int *width;
+    long trail_len;
+    long trail_cap;
+} LFQSchedConfig;
+
+// =======================
+// Functions
+// =======================
+
+// -------- Reclamation and memory telemetry -----
+// Counted allocation for queue memory; exits on failure. Memory that goes
+// through retired_list_add must come from node_alloc.
+void *node_alloc(size_t size);
+void node_free(void *p);
+void retired_list_init();
+void retired_list_add(void *node);
+void retired_list_cleanup();
+void mem_stats_snapshot(MemStats *out);
+void mem_stats_reset(void);
+
+// -------- Lock-free operation statistics -----
+void lfq_stats_snapshot(LFQStats *out);
+void lfq_stats_reset(void);
+void lfq_stats_print(FILE *f, const LFQStats *s, const char *indent);
+
+// -------- Lock-free queue -----
+void lfqueue_init(LFQueue *q);
+void lfqueue_destroy(LFQueue *q);
+int lfqueue_enqueue(LFQueue *q, int value);
+int lfqueue_try_dequeue(LFQueue *q, int *out_value);
+int lfqueue_dequeue(LFQueue *q, int *out_value);
+void lfqueue_close(LFQueue *q);
+int lfqueue_is_closed(LFQueue *q);
+int lfqueue_size(LFQueue *q);
+int lfqueue_notify_fd(LFQueue *q);
+int lfqueue_drain(LFQueue *q, int *out, int max);
+int lfqueue_rearm(LFQueue *q);
+
+// -------- Lock-based queue -----
+void lockedqueue_init(LockedQueue *q);
+void lockedqueue_destroy(LockedQueue *q);
+void lockedqueue_enqueue(LockedQueue *q, int value);
+int lockedqueue_dequeue(LockedQueue *q, int *out_value);
+
+// -------- Relaxed MultiQueue -----
+void multiqueue_init(MultiQueue *mq, int num_shards);
+void multiqueue_destroy(MultiQueue *mq);
+int multiqueue_enqueue(MultiQueue *mq, int value);
+int multiqueue_dequeue(MultiQueue *mq, int *out_value);
+int multiqueue_size(MultiQueue *mq);
+
+// -------- Lock-free priority queue -----
+void lfpq_init(LFPriorityQueue *q);
+void lfpq_destroy(LFPriorityQueue *q);
+void lfpq_insert(LFPriorityQueue *q, int key, int value);
+int lfpq_delete_min(LFPriorityQueue *q, int *out_key, int *out_value);
+int lfpq_size(LFPriorityQueue *q);
+
+// -------- Lock-free stack -----
+void lfstack_init(LFStack *s, int use_elimination);
+void lfstack_destroy(LFStack *s);
+void lfstack_push(LFStack *s, int value);
+int lfstack_pop(LFStack *s, int *out_value);
+int lfstack_size(LFStack *s);
+
+// -------- Multicast ring -----
+void ring_init(MulticastRing *r, int capacity, int multi_producer);
+void ring_destroy(MulticastRing *r);
+int ring_add_consumer(MulticastRing *r, const int *deps, int num_deps);
+int64_t ring_claim(MulticastRing *r);
+void ring_publish(MulticastRing *r, int64_t seq);
+void ring_publish_value(MulticastRing *r, int value);
+int64_t ring_wait_for(MulticastRing *r, int consumer, int64_t seq);
+void ring_release(MulticastRing *r, int consumer, int64_t seq);
+
+// Zero-copy access: producers write and consumers read the slot in place
+static inline int *ring_slot(MulticastRing *r, int64_t seq) {
+    return &r->slots[seq & r->mask];
+}
+
+// -------- Bounded queue -----
+void bq_init(BoundedQueue *q, size_t capacity);
+void bq_destroy(BoundedQueue *q);
+int bq_try_reserve(BoundedQueue *q, int n, BQReservation *res);
+void bq_commit(BoundedQueue *q, const BQReservation *res);
+int bq_try_enqueue(BoundedQueue *q, int value);
+int bq_reserve_timed(BoundedQueue *q, int n, BQReservation *res, int timeout_ms);
+int bq_enqueue_timed(BoundedQueue *q, int value, int timeout_ms);
+int bq_dequeue(BoundedQueue *q, int *out_value);
+int bq_size(BoundedQueue *q);
+
+// Pointer to the i-th reserved slot, for writing the item in place
+static inline int *bq_slot(BoundedQueue *q, const BQReservation *res, int i) {
+    return &q->slots[(res->start + i) & q->mask].value;
+}
+
+// -------- Async channel -----
+void chan_executor_start(ChanExecutor *e);
+void chan_executor_stop(ChanExecutor *e);
+void chan_init(AsyncChannel *ch, size_t capacity, ChanExecutor *exec);
+void chan_destroy(AsyncChannel *ch);
+int chan_try_pop(AsyncChannel *ch, int *out_value);
+int chan_try_push(AsyncChannel *ch, int value);
+int chan_pop_async(AsyncChannel *ch, int *out_value, ChanWaiter *w, void (*resume)(ChanWaiter *));
+int chan_push_async(AsyncChannel *ch, int value, ChanWaiter *w, void (*resume)(ChanWaiter *));
+
+// -------- Shared-memory queue -----
+int shmq_open(ShmQueue *q, const char *name, uint32_t capacity);
+void shmq_close(ShmQueue *q);
+int shmq_unlink(const char *name);
+int shmq_enqueue(ShmQueue *q, int value);
+int shmq_dequeue(ShmQueue *q, int *out_value);
+int shmq_size(ShmQueue *q);
+int shmq_recover(ShmQueue *q);
+
+// -------- Durable queue -----
+int dq_open(DurableQueue *q, const char *path, uint32_t capacity, int persist);
+void dq_close(DurableQueue *q);
+int dq_enqueue(DurableQueue *q, int value);
+int dq_dequeue(DurableQueue *q, int *out_value);
+int dq_size(DurableQueue *q);
+
+// -------- Deterministic scheduler -----
+// Runs body(arg, id) for id 0..nthreads-1 under cfg and returns the number of
+// scheduling decisions made. lfq_sched_next moves cfg to the next schedule:
+// the next seed, or for DFS the next unexplored branch (0 once exhausted).
+long lfq_sched_run(LFQSchedConfig *cfg, int nthreads, void (*body)(void *arg, int id), void *arg);
+int lfq_sched_next(LFQSchedConfig *cfg);
+void lfq_sched_free(LFQSchedConfig *cfg);
+
+// -------- Lock-based priority queue -----
+void lockedpq_init(LockedPQ *q);
+void lockedpq_destroy(LockedPQ *q);
+void lockedpq_insert(LockedPQ *q, int key, int value);
+int lockedpq_delete_min(LockedPQ *q, int *out_key, int *out_value);
+
+#endif // LFQ_H
@@ -0,0 +1,58 @@
+// lfq_atomic.h
+// Atomic operations used by the queue algorithms, each with its memory order
+// spelled out. Build flags change them for checking:
+//   LFQ_SEQ_CST   every order becomes memory_order_seq_cst, to rule out an
+//                 ordering bug or to measure what the weaker orders save
+//   LFQ_VALIDATE  a random delay before every operation, so interleavings
+//                 that are rare at full speed show up in ordinary stress runs
+//   LFQ_SCHED     every operation is a switch point for lfq_sched_run
+// A ThreadSanitizer build (-DLFQ_TSAN=ON) checks the orders themselves: a
+// plain field read that is not ordered after the write that published it is
+// reported as a race.
+
+#ifndef LFQ_ATOMIC_H
+#define LFQ_ATOMIC_H
+
+#include <stdatomic.h>
+
+#ifdef LFQ_SEQ_CST
+#define LFQ_RELAXED memory_order_seq_cst
+#define LFQ_ACQUIRE memory_order_seq_cst
+#define LFQ_RELEASE memory_order_seq_cst
+#define LFQ_ACQ_REL memory_order_seq_cst
+#else
+#define LFQ_RELAXED memory_order_relaxed
+#define LFQ_ACQUIRE memory_order_acquire
+#define LFQ_RELEASE memory_order_release
+#define LFQ_ACQ_REL memory_order_acq_rel
+#endif
+#define LFQ_SEQ memory_order_seq_cst
+
+// Spins, yields or does nothing, chosen at random per call. Always built
+// into the library so code compiled with LFQ_VALIDATE links against any build.
+void lfq_validate_delay(void);
+// Hands the turn to whichever thread lfq_sched_run picks next; returns at
+// once outside a scheduled run
+void lfq_sched_point(void);
+
+#if defined(LFQ_SCHED)
+#define LFQ_HOOK() lfq_sched_point()
+#elif defined(LFQ_VALIDATE)
+#define LFQ_HOOK() lfq_validate_delay()
+#else
+#define LFQ_HOOK() ((void)0)
+#endif
+
+#define LFQ_LOAD(obj, order) (LFQ_HOOK(), atomic_load_explicit((obj), (order)))
+#define LFQ_STORE(obj, value, order) (LFQ_HOOK(), atomic_store_explicit((obj), (value), (order)))
+#define LFQ_EXCHANGE(obj, value, order) (LFQ_HOOK(), atomic_exchange_explicit((obj), (value), (order)))
+#define LFQ_FETCH_ADD(obj, n, order) (LFQ_HOOK(), atomic_fetch_add_explicit((obj), (n), (order)))
+#define LFQ_FETCH_SUB(obj, n, order) (LFQ_HOOK(), atomic_fetch_sub_explicit((obj), (n), (order)))
+#define LFQ_FETCH_OR(obj, bits, order) (LFQ_HOOK(), atomic_fetch_or_explicit((obj), (bits), (order)))
+// Failure order is always relaxed: every caller reloads before it retries
+#define LFQ_CAS(obj, expected, desired, order) \
+    (LFQ_HOOK(), atomic_compare_exchange_strong_explicit((obj), (expected), (desired), (order), LFQ_RELAXED))
+#define LFQ_CAS_WEAK(obj, expected, desired, order) \
+    (LFQ_HOOK(), atomic_compare_exchange_weak_explicit((obj), (expected), (desired), (order), LFQ_RELAXED))
+
+#endif // LFQ_ATOMIC_H
@@ -0,0 +1,103 @@
+// lfq_chan.hpp
+// C++20 awaiters over the async channel, so a coroutine can write
+//   std::optional<int> v = co_await lfq::pop(ch);
+//   bool pushed = co_await lfq::push(ch, x);
+// instead of a ChanWaiter and a resume callback of its own. Header-only;
+// link with -llfq -pthread like the C interface.
+//
+// await_ready tries the channel without parking. If that fails,
+// await_suspend parks the awaiter's ChanWaiter and its callback resumes the
+// coroutine, inline on the thread that made progress possible or on the
+// channel's executor. A task still parked when chan_destroy runs is resumed
+// with an empty optional (pop) or false (push) and must not touch the
+// channel again.
+
+#ifndef LFQ_CHAN_HPP
+#define LFQ_CHAN_HPP
+
+#include <coroutine>
+#include <optional>
+#include <type_traits>
+#include <version>
+
+// lfq.h declares its atomics with C11 _Atomic(T). Before C++23's
+// <stdatomic.h> that spelling needs mapping onto std::atomic, which GCC and
+// Clang lay out the same way for the lock-free types the structs use.
+#ifndef __cpp_lib_stdatomic_h
+#include <atomic>
+#define _Atomic(T) std::atomic<T>
+#endif
+
+extern "C" {
+#include "lfq.h"
+}
+
+namespace lfq {
+
+// co_await lfq::pop(ch): the item, or std::nullopt if the channel was
+// destroyed while this task was parked
+class PopAwaiter {
+public:
+    explicit PopAwaiter(AsyncChannel *ch) : ch_(ch) {}
+
+    bool await_ready() {
+        waiter_.status = LFQ_OK;
+        return chan_try_pop(ch_, &waiter_.value) != 0;
+    }
+
+    // false resumes at once: the item arrived between await_ready and here.
+    // Otherwise the coroutine may already be running again on another path
+    // when this returns, so nothing here touches *this after the park.
+    bool await_suspend(std::coroutine_handle<> h) {
+        handle_ = h;
+        return chan_pop_async(ch_, &waiter_.value, &waiter_, resume) == 0;
+    }
+
+    std::optional<int> await_resume() const {
+        if (waiter_.status == LFQ_CLOSED) return std::nullopt;
+        return waiter_.value;
+    }
+
+private:
+    static void resume(ChanWaiter *w) { reinterpret_cast<PopAwaiter *>(w)->handle_.resume(); }
+
+    ChanWaiter waiter_{};  // First member, so the callback converts back
+    AsyncChannel *ch_;
+    std::coroutine_handle<> handle_;
+};
+
+// co_await lfq::push(ch, x): true once x is in the channel, false if the
+// channel was destroyed while this task was parked
+class PushAwaiter {
+public:
+    PushAwaiter(AsyncChannel *ch, int value) : ch_(ch) { waiter_.value = value; }
+
+    bool await_ready() {
+        waiter_.status = LFQ_OK;
+        return chan_try_push(ch_, waiter_.value) != 0;
+    }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        handle_ = h;
+        return chan_push_async(ch_, waiter_.value, &waiter_, resume) == 0;
+    }
+
+    bool await_resume() const { return waiter_.status != LFQ_CLOSED; }
+
+private:
+    static void resume(ChanWaiter *w) { reinterpret_cast<PushAwaiter *>(w)->handle_.resume(); }
+
+    ChanWaiter waiter_{};
+    AsyncChannel *ch_;
+    std::coroutine_handle<> handle_;
+};
+
+static_assert(std::is_standard_layout_v<PopAwaiter> && std::is_standard_layout_v<PushAwaiter>,
+              "the resume callbacks cast the ChanWaiter back to its awaiter");
+
+inline PopAwaiter pop(AsyncChannel &ch) { return PopAwaiter(&ch); }
+inline PushAwaiter push(AsyncChannel &ch, int value) { return PushAwaiter(&ch, value); }
+
+} // namespace lfq
+
+#endif // LFQ_CHAN_HPP
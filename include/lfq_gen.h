@@ -0,0 +1,306 @@
+// lfq_gen.h
+// Queue types specialized at compile time. Every choice LFQueue makes at run
+// time or pays for on every call (int payload, shared size counter, CAS on
+// both ends, retired list) is fixed per instantiation instead, and the
+// operations are static inline, so the hot path has no configuration
+// branches and inlines into the caller.
+//
+//   LFQ_DEFINE(name, type, mode, bound, reclaim)
+//
+//   mode     SPSC, MPSC or MPMC: how many threads may enqueue / dequeue
+//            concurrently
+//   bound    UNBOUNDED  linked nodes from node_alloc
+//            BOUNDED    ring of slots allocated by name_init
+//   reclaim  what happens to a dequeued node
+//            FREE    node_free at once. Single-consumer modes only: no other
+//                    thread can still be reading the node
+//            RETIRE  retired_list_add, as LFQueue does (any mode)
+//            NONE    BOUNDED queues, which allocate nothing per item
+//   Unsupported combinations fail to compile with a static assertion.
+//
+// Each instantiation defines the type `name` and
+//   void name_init(name *q, size_t capacity)   capacity ignored if UNBOUNDED
+//   void name_destroy(name *q)
+//   int  name_enqueue(name *q, type value)     0 if a BOUNDED queue is full
+//   int  name_dequeue(name *q, type *out)      0 if empty, or (MPMC BOUNDED) while
+//                                              the next slot is reserved but not
+//                                              yet written, as in bq_dequeue
+//
+// Example, at file scope:
+//   LFQ_DEFINE(evq, struct event, MPSC, UNBOUNDED, FREE)
+
+#ifndef LFQ_GEN_H
+#define LFQ_GEN_H
+
+#include "lfq.h"
+#include "lfq_atomic.h"
+
+#define LFQ_DEFINE(name, type, mode, bound, reclaim) \
+    LFQ_DEFINE_##mode##_##bound(name, type, reclaim)
+
+// Smallest power of two >= n, at least 2
+static inline size_t lfq_gen_capacity(size_t n) {
+    size_t c = 2;
+    while (c < n) c <<= 1;
+    return c;
+}
+
+// -------- Reclamation policies -----
+#define LFQ_RECLAIM_SC_FREE(p) node_free(p)
+#define LFQ_RECLAIM_SC_RETIRE(p) retired_list_add(p)
+#define LFQ_RECLAIM_SC_NONE(p) _Static_assert(0, "UNBOUNDED queues take FREE or RETIRE")
+#define LFQ_RECLAIM_MC_FREE(p) _Static_assert(0, "FREE needs a single consumer; use RETIRE")
+#define LFQ_RECLAIM_MC_RETIRE(p) retired_list_add(p)
+#define LFQ_RECLAIM_MC_NONE(p) _Static_assert(0, "UNBOUNDED queues take FREE or RETIRE")
+#define LFQ_RECLAIM_RING_NONE _Static_assert(1, "")
+#define LFQ_RECLAIM_RING_FREE _Static_assert(0, "BOUNDED queues take NONE")
+#define LFQ_RECLAIM_RING_RETIRE _Static_assert(0, "BOUNDED queues take NONE")
+
+// -------- Linked queues -----
+// Dummy-headed list as in LFQueue. head belongs to the consumer side and
+// tail to the producer side; they sit on separate cache lines.
+#define LFQ_GEN_LIST_TYPES(name, type, head_t, tail_t) \
+    typedef struct name##_node { \
+        _Atomic(struct name##_node *) next; \
+        type value; \
+    } name##_node; \
+    typedef struct { \
+        head_t head; \
+        char pad0[64]; \
+        tail_t tail; \
+        char pad1[64]; \
+    } name; \
+    static inline name##_node *name##_new_node(void) { \
+        name##_node *n = (name##_node *)node_alloc(sizeof(name##_node)); \
+        atomic_init(&n->next, NULL); \
+        return n; \
+    } \
+    static inline void name##_init(name *q, size_t capacity) { \
+        (void)capacity; \
+        name##_node *dummy = name##_new_node(); \
+        q->head = dummy; \
+        q->tail = dummy; \
+    } \
+    static inline void name##_destroy(name *q) { \
+        name##_node *cur = q->head; \
+        while (cur != NULL) { \
+            name##_node *next = atomic_load_explicit(&cur->next, memory_order_relaxed); \
+            node_free(cur); \
+            cur = next; \
+        } \
+    }
+
+// Single consumer: no CAS, the old dummy is released as soon as head moves
+#define LFQ_GEN_LIST_SC_DEQUEUE(name, type, reclaim) \
+    static inline int name##_dequeue(name *q, type *out) { \
+        name##_node *head = q->head; \
+        name##_node *next = LFQ_LOAD(&head->next, LFQ_ACQUIRE); \
+        if (next == NULL) return 0; \
+        *out = next->value; \
+        q->head = next; \
+        LFQ_RECLAIM_SC_##reclaim(head); \
+        return 1; \
+    }
+
+// SPSC: the producer owns tail outright, so linking is one release store
+#define LFQ_DEFINE_SPSC_UNBOUNDED(name, type, reclaim) \
+    LFQ_GEN_LIST_TYPES(name, type, name##_node *, name##_node *) \
+    static inline int name##_enqueue(name *q, type value) { \
+        name##_node *n = name##_new_node(); \
+        n->value = value; \
+        LFQ_STORE(&q->tail->next, n, LFQ_RELEASE); \
+        q->tail = n; \
+        return 1; \
+    } \
+    LFQ_GEN_LIST_SC_DEQUEUE(name, type, reclaim)
+
+// MPSC (Vyukov): producers swap themselves into tail and then link the
+// previous node, one exchange and no retry loop. A producer preempted
+// between the two steps hides the items behind it until it runs again.
+#define LFQ_DEFINE_MPSC_UNBOUNDED(name, type, reclaim) \
+    LFQ_GEN_LIST_TYPES(name, type, name##_node *, _Atomic(name##_node *)) \
+    static inline int name##_enqueue(name *q, type value) { \
+        name##_node *n = name##_new_node(); \
+        n->value = value; \
+        name##_node *prev = LFQ_EXCHANGE(&q->tail, n, LFQ_ACQ_REL); \
+        LFQ_STORE(&prev->next, n, LFQ_RELEASE); \
+        return 1; \
+    } \
+    LFQ_GEN_LIST_SC_DEQUEUE(name, type, reclaim)
+
+// MPMC: Michael & Scott without the size counter or statistics hooks, with
+// the same memory orders as lfqueue.c
+#define LFQ_DEFINE_MPMC_UNBOUNDED(name, type, reclaim) \
+    LFQ_GEN_LIST_TYPES(name, type, _Atomic(name##_node *), _Atomic(name##_node *)) \
+    static inline int name##_enqueue(name *q, type value) { \
+        name##_node *n = name##_new_node(); \
+        n->value = value; \
+        while (1) { \
+            name##_node *tail = LFQ_LOAD(&q->tail, LFQ_ACQUIRE); \
+            name##_node *next = LFQ_LOAD(&tail->next, LFQ_ACQUIRE); \
+            if (tail != LFQ_LOAD(&q->tail, LFQ_RELAXED)) continue; \
+            if (next == NULL) { \
+                if (LFQ_CAS_WEAK(&tail->next, &next, n, LFQ_RELEASE)) { \
+                    LFQ_CAS(&q->tail, &tail, n, LFQ_RELEASE); \
+                    return 1; \
+                } \
+            } else { \
+                LFQ_CAS(&q->tail, &tail, next, LFQ_RELEASE); \
+            } \
+        } \
+    } \
+    static inline int name##_dequeue(name *q, type *out) { \
+        while (1) { \
+            name##_node *head = LFQ_LOAD(&q->head, LFQ_ACQUIRE); \
+            name##_node *tail = LFQ_LOAD(&q->tail, LFQ_RELAXED); \
+            name##_node *next = LFQ_LOAD(&head->next, LFQ_ACQUIRE); \
+            if (head != LFQ_LOAD(&q->head, LFQ_RELAXED)) continue; \
+            if (head == tail) { \
+                if (next == NULL) return 0; \
+                LFQ_CAS(&q->tail, &tail, next, LFQ_RELEASE); \
+            } else { \
+                type value = next->value; \
+                if (LFQ_CAS_WEAK(&q->head, &head, next, LFQ_RELEASE)) { \
+                    *out = value; \
+                    LFQ_RECLAIM_MC_##reclaim(head); \
+                    return 1; \
+                } \
+            } \
+        } \
+    }
+
+// -------- Bounded queues -----
+// SPSC (Lamport ring): each side caches the other side's index and only
+// reloads it when the ring looks full or empty, so the common case touches
+// no shared cache line but the slot.
+#define LFQ_DEFINE_SPSC_BOUNDED(name, type, reclaim) \
+    LFQ_RECLAIM_RING_##reclaim; \
+    typedef struct { \
+        type *slots; \
+        size_t mask; \
+        char pad0[64]; \
+        _Atomic(size_t) tail; \
+        size_t head_cache;        /* Producer's copy of head */ \
+        char pad1[64]; \
+        _Atomic(size_t) head; \
+        size_t tail_cache;        /* Consumer's copy of tail */ \
+        char pad2[64]; \
+    } name; \
+    static inline void name##_init(name *q, size_t capacity) { \
+        size_t cap = lfq_gen_capacity(capacity); \
+        q->slots = (type *)node_alloc(cap * sizeof(type)); \
+        q->mask = cap - 1; \
+        atomic_init(&q->tail, 0); \
+        atomic_init(&q->head, 0); \
+        q->head_cache = 0; \
+        q->tail_cache = 0; \
+    } \
+    static inline void name##_destroy(name *q) { \
+        node_free(q->slots); \
+    } \
+    static inline int name##_enqueue(name *q, type value) { \
+        size_t t = LFQ_LOAD(&q->tail, LFQ_RELAXED); \
+        if (t - q->head_cache > q->mask) { \
+            q->head_cache = LFQ_LOAD(&q->head, LFQ_ACQUIRE); \
+            if (t - q->head_cache > q->mask) return 0; \
+        } \
+        q->slots[t & q->mask] = value; \
+        LFQ_STORE(&q->tail, t + 1, LFQ_RELEASE); \
+        return 1; \
+    } \
+    static inline int name##_dequeue(name *q, type *out) { \
+        size_t h = LFQ_LOAD(&q->head, LFQ_RELAXED); \
+        if (h == q->tail_cache) { \
+            q->tail_cache = LFQ_LOAD(&q->tail, LFQ_ACQUIRE); \
+            if (h == q->tail_cache) return 0; \
+        } \
+        *out = q->slots[h & q->mask]; \
+        LFQ_STORE(&q->head, h + 1, LFQ_RELEASE); \
+        return 1; \
+    }
+
+// Vyukov ring as in BoundedQueue, without the blocking-producer support
+#define LFQ_GEN_RING_MP(name, type, reclaim, deq_t) \
+    LFQ_RECLAIM_RING_##reclaim; \
+    typedef struct { \
+        _Atomic(size_t) seq; \
+        type value; \
+    } name##_slot; \
+    typedef struct { \
+        name##_slot *slots; \
+        size_t mask; \
+        char pad0[64]; \
+        _Atomic(size_t) enq_pos; \
+        char pad1[64]; \
+        deq_t deq_pos; \
+        char pad2[64]; \
+    } name; \
+    static inline void name##_init(name *q, size_t capacity) { \
+        size_t cap = lfq_gen_capacity(capacity); \
+        q->slots = (name##_slot *)node_alloc(cap * sizeof(name##_slot)); \
+        for (size_t i = 0; i < cap; i++) { \
+            atomic_init(&q->slots[i].seq, i); \
+        } \
+        q->mask = cap - 1; \
+        atomic_init(&q->enq_pos, 0); \
+        q->deq_pos = 0; \
+    } \
+    static inline void name##_destroy(name *q) { \
+        node_free(q->slots); \
+    } \
+    static inline int name##_enqueue(name *q, type value) { \
+        size_t pos = LFQ_LOAD(&q->enq_pos, LFQ_RELAXED); \
+        name##_slot *slot; \
+        while (1) { \
+            slot = &q->slots[pos & q->mask]; \
+            size_t seq = LFQ_LOAD(&slot->seq, LFQ_ACQUIRE); \
+            intptr_t dif = (intptr_t)seq - (intptr_t)pos; \
+            if (dif == 0) { \
+                if (LFQ_CAS_WEAK(&q->enq_pos, &pos, pos + 1, LFQ_RELAXED)) break; \
+            } else if (dif < 0) { \
+                return 0; \
+            } else { \
+                pos = LFQ_LOAD(&q->enq_pos, LFQ_RELAXED); \
+            } \
+        } \
+        slot->value = value; \
+        LFQ_STORE(&slot->seq, pos + 1, LFQ_RELEASE); \
+        return 1; \
+    }
+
+// MPSC: the single consumer owns deq_pos, so a dequeue is one load and one store
+#define LFQ_DEFINE_MPSC_BOUNDED(name, type, reclaim) \
+    LFQ_GEN_RING_MP(name, type, reclaim, size_t) \
+    static inline int name##_dequeue(name *q, type *out) { \
+        size_t pos = q->deq_pos; \
+        name##_slot *slot = &q->slots[pos & q->mask]; \
+        if (LFQ_LOAD(&slot->seq, LFQ_ACQUIRE) != pos + 1) return 0; \
+        *out = slot->value; \
+        LFQ_STORE(&slot->seq, pos + q->mask + 1, LFQ_RELEASE); \
+        q->deq_pos = pos + 1; \
+        return 1; \
+    }
+
+#define LFQ_DEFINE_MPMC_BOUNDED(name, type, reclaim) \
+    LFQ_GEN_RING_MP(name, type, reclaim, _Atomic(size_t)) \
+    static inline int name##_dequeue(name *q, type *out) { \
+        size_t pos = LFQ_LOAD(&q->deq_pos, LFQ_RELAXED); \
+        name##_slot *slot; \
+        while (1) { \
+            slot = &q->slots[pos & q->mask]; \
+            size_t seq = LFQ_LOAD(&slot->seq, LFQ_ACQUIRE); \
+            intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1); \
+            if (dif == 0) { \
+                if (LFQ_CAS_WEAK(&q->deq_pos, &pos, pos + 1, LFQ_RELAXED)) break; \
+            } else if (dif < 0) { \
+                return 0; \
+            } else { \
+                pos = LFQ_LOAD(&q->deq_pos, LFQ_RELAXED); \
+            } \
+        } \
+        *out = slot->value; \
+        LFQ_STORE(&slot->seq, pos + q->mask + 1, LFQ_RELEASE); \
+        return 1; \
+    }
+
+#endif // LFQ_GEN_H
@@ -0,0 +1,170 @@
+// bounded.c
+// Bounded MPMC queue (Vyukov ring) with timed blocking enqueue
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Bounded queue functions
+// =======================
+
+void bq_init(BoundedQueue *q, size_t capacity) {
+    size_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+
+    q->slots = node_alloc(cap * sizeof(BQSlot));
+    q->capacity = cap;
+    q->mask = cap - 1;
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(&q->slots[i].seq, i);
+    }
+    atomic_init(&q->enq_pos, 0);
+    atomic_init(&q->deq_pos, 0);
+    atomic_init(&q->waiters, 0);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&q->not_full, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&q->wait_lock, NULL);
+}
+
+void bq_destroy(BoundedQueue *q) {
+    node_free(q->slots);
+    pthread_cond_destroy(&q->not_full);
+    pthread_mutex_destroy(&q->wait_lock);
+}
+
+// Claims n consecutive slots without blocking. Returns 0 if fewer than n are
+// free. Consumers cannot see the slots until bq_commit, and items enqueued
+// after an open reservation wait behind it.
+int bq_try_reserve(BoundedQueue *q, int n, BQReservation *res) {
+    if (n <= 0 || (size_t)n > q->capacity) return 0;
+
+    size_t pos = LFQ_LOAD(&q->enq_pos, LFQ_SEQ);
+    for (int retries = 0;; retries++) {
+        int stale = 0;
+        for (int i = 0; i < n; i++) {
+            size_t seq = LFQ_LOAD(&q->slots[(pos + i) & q->mask].seq, LFQ_SEQ);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + i);
+            if (diff < 0) {
+                LFQ_STAT_EMPTY(LFQ_OP_BQ_RESERVE); // Counts full-queue returns
+                LFQ_STAT_DONE(LFQ_OP_BQ_RESERVE, retries);
+                return 0; // Slot still holds an unconsumed item
+            }
+            if (diff > 0) {
+                stale = 1;
+                break;
+            }
+        }
+        if (stale) {
+            pos = LFQ_LOAD(&q->enq_pos, LFQ_SEQ);
+        } else if (LFQ_STAT_CAS(LFQ_OP_BQ_RESERVE, LFQ_CAS_WEAK(&q->enq_pos, &pos, pos + n, LFQ_SEQ))) {
+            res->start = pos;
+            res->count = n;
+            LFQ_STAT_DONE(LFQ_OP_BQ_RESERVE, retries);
+            return 1;
+        }
+    }
+}
+
+void bq_commit(BoundedQueue *q, const BQReservation *res) {
+    for (int i = 0; i < res->count; i++) {
+        LFQ_STORE(&q->slots[(res->start + i) & q->mask].seq, res->start + i + 1, LFQ_SEQ);
+    }
+}
+
+int bq_try_enqueue(BoundedQueue *q, int value) {
+    BQReservation res;
+    if (!bq_try_reserve(q, 1, &res)) return 0; // Queue is full
+    *bq_slot(q, &res, 0) = value;
+    bq_commit(q, &res);
+    return 1;
+}
+
+// Blocks until n slots are free. timeout_ms < 0 waits forever; returns 0 on timeout.
+int bq_reserve_timed(BoundedQueue *q, int n, BQReservation *res, int timeout_ms) {
+    if (bq_try_reserve(q, n, res)) return 1;
+    if (n <= 0 || (size_t)n > q->capacity) return 0;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    if (timeout_ms > 0) {
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    // Registering before the re-check pairs with the waiters load in bq_dequeue
+    LFQ_FETCH_ADD(&q->waiters, 1, LFQ_SEQ);
+    pthread_mutex_lock(&q->wait_lock);
+    int ok;
+    while (!(ok = bq_try_reserve(q, n, res))) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&q->not_full, &q->wait_lock);
+        } else if (pthread_cond_timedwait(&q->not_full, &q->wait_lock, &deadline) == ETIMEDOUT) {
+            ok = bq_try_reserve(q, n, res);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&q->wait_lock);
+    LFQ_FETCH_SUB(&q->waiters, 1, LFQ_SEQ);
+    return ok;
+}
+
+int bq_enqueue_timed(BoundedQueue *q, int value, int timeout_ms) {
+    BQReservation res;
+    if (!bq_reserve_timed(q, 1, &res, timeout_ms)) return 0;
+    *bq_slot(q, &res, 0) = value;
+    bq_commit(q, &res);
+    return 1;
+}
+
+// Returns 0 if the slot at deq_pos holds no committed item. That includes the
+// case where an enqueue has reserved that slot but not committed it yet while
+// later enqueues have already committed theirs: the queue holds items but the
+// dequeue reports empty. Items still come out in FIFO order, so the ring is
+// linearizable except for these empty results.
+int bq_dequeue(BoundedQueue *q, int *out_value) {
+    size_t pos = LFQ_LOAD(&q->deq_pos, LFQ_SEQ);
+    BQSlot *slot;
+
+    for (int retries = 0;; retries++) {
+        slot = &q->slots[pos & q->mask];
+        size_t seq = LFQ_LOAD(&slot->seq, LFQ_SEQ);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (LFQ_STAT_CAS(LFQ_OP_BQ_DEQUEUE, LFQ_CAS_WEAK(&q->deq_pos, &pos, pos + 1, LFQ_SEQ))) {
+                LFQ_STAT_DONE(LFQ_OP_BQ_DEQUEUE, retries);
+                break;
+            }
+        } else if (diff < 0) {
+            LFQ_STAT_EMPTY(LFQ_OP_BQ_DEQUEUE);
+            LFQ_STAT_DONE(LFQ_OP_BQ_DEQUEUE, retries);
+            return 0; // Empty, or the next slot is reserved but not committed
+        } else {
+            pos = LFQ_LOAD(&q->deq_pos, LFQ_SEQ);
+        }
+    }
+
+    if (out_value) {
+        *out_value = slot->value;
+    }
+    LFQ_STORE(&slot->seq, pos + q->capacity, LFQ_SEQ);
+
+    if (LFQ_LOAD(&q->waiters, LFQ_SEQ) > 0) {
+        pthread_mutex_lock(&q->wait_lock);
+        pthread_cond_broadcast(&q->not_full);
+        pthread_mutex_unlock(&q->wait_lock);
+    }
+    return 1;
+}
+
+int bq_size(BoundedQueue *q) {
+    return (int)(LFQ_LOAD(&q->enq_pos, LFQ_SEQ) - LFQ_LOAD(&q->deq_pos, LFQ_SEQ));
+}
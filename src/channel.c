@@ -0,0 +1,213 @@
+// channel.c
+// Async channel: callback continuations over BoundedQueue
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Async channel functions
+// =======================
+
+static void waiter_list_push(_Atomic(ChanWaiter *) *list, ChanWaiter *first, ChanWaiter *last) {
+    ChanWaiter *top = LFQ_LOAD(list, LFQ_SEQ);
+    do {
+        last->next = top;
+    } while (!LFQ_CAS_WEAK(list, &top, first, LFQ_SEQ));
+}
+
+// Takes the whole list and returns it oldest first
+static ChanWaiter *waiter_list_take(_Atomic(ChanWaiter *) *list) {
+    ChanWaiter *w = LFQ_EXCHANGE(list, NULL, LFQ_SEQ);
+    ChanWaiter *fifo = NULL;
+    while (w != NULL) {
+        ChanWaiter *next = w->next;
+        w->next = fifo;
+        fifo = w;
+        w = next;
+    }
+    return fifo;
+}
+
+static void *chan_executor_thread(void *arg) {
+    ChanExecutor *e = (ChanExecutor *)arg;
+    for (;;) {
+        ChanWaiter *w = waiter_list_take(&e->ready);
+        if (w != NULL) {
+            while (w != NULL) {
+                ChanWaiter *next = w->next;
+                w->resume(w);
+                w = next;
+            }
+            continue;
+        }
+        if (LFQ_LOAD(&e->stop, LFQ_SEQ)) break;
+
+        // Announce the sleep before the last look; pairs with chan_executor_submit
+        LFQ_STORE(&e->sleeping, 1, LFQ_SEQ);
+        pthread_mutex_lock(&e->lock);
+        while (LFQ_LOAD(&e->ready, LFQ_SEQ) == NULL && !LFQ_LOAD(&e->stop, LFQ_SEQ)) {
+            pthread_cond_wait(&e->wake, &e->lock);
+        }
+        pthread_mutex_unlock(&e->lock);
+        LFQ_STORE(&e->sleeping, 0, LFQ_SEQ);
+    }
+    return NULL;
+}
+
+void chan_executor_start(ChanExecutor *e) {
+    atomic_init(&e->ready, NULL);
+    atomic_init(&e->sleeping, 0);
+    atomic_init(&e->stop, 0);
+    pthread_mutex_init(&e->lock, NULL);
+    pthread_cond_init(&e->wake, NULL);
+    pthread_create(&e->thread, NULL, chan_executor_thread, e);
+}
+
+// Runs every continuation already submitted, then joins the thread
+void chan_executor_stop(ChanExecutor *e) {
+    pthread_mutex_lock(&e->lock);
+    LFQ_STORE(&e->stop, 1, LFQ_SEQ);
+    pthread_cond_signal(&e->wake);
+    pthread_mutex_unlock(&e->lock);
+    pthread_join(e->thread, NULL);
+    pthread_cond_destroy(&e->wake);
+    pthread_mutex_destroy(&e->lock);
+}
+
+static void chan_executor_submit(ChanExecutor *e, ChanWaiter *w) {
+    waiter_list_push(&e->ready, w, w);
+    if (LFQ_LOAD(&e->sleeping, LFQ_SEQ)) {
+        pthread_mutex_lock(&e->lock);
+        pthread_cond_signal(&e->wake);
+        pthread_mutex_unlock(&e->lock);
+    }
+}
+
+void chan_init(AsyncChannel *ch, size_t capacity, ChanExecutor *exec) {
+    bq_init(&ch->q, capacity);
+    atomic_init(&ch->pop_inbox, NULL);
+    atomic_init(&ch->push_inbox, NULL);
+    atomic_init(&ch->pop_parked, 0);
+    atomic_init(&ch->push_parked, 0);
+    atomic_init(&ch->dispatch, 0);
+    ch->pop_head = ch->pop_tail = NULL;
+    ch->push_head = ch->push_tail = NULL;
+    ch->exec = exec;
+}
+
+static void chan_resume(AsyncChannel *ch, ChanWaiter *w) {
+    w->next = NULL;
+    if (ch->exec) chan_executor_submit(ch->exec, w);
+    else w->resume(w);
+}
+
+// Appends everything parked in inbox to a dispatcher FIFO, oldest first
+static void chan_collect(_Atomic(ChanWaiter *) *inbox, ChanWaiter **head, ChanWaiter **tail) {
+    ChanWaiter *w = waiter_list_take(inbox);
+    if (w == NULL) return;
+    if (*tail) (*tail)->next = w;
+    else *head = w;
+    while (w->next != NULL) w = w->next;
+    *tail = w;
+}
+
+// Resumes every waiter still parked with status LFQ_CLOSED, so a suspended
+// task ends instead of leaking. Its callback runs inline or on the executor
+// and must not use the channel again. No other call on the channel may be
+// in progress.
+void chan_destroy(AsyncChannel *ch) {
+    chan_collect(&ch->pop_inbox, &ch->pop_head, &ch->pop_tail);
+    chan_collect(&ch->push_inbox, &ch->push_head, &ch->push_tail);
+    ChanWaiter *parked[] = {ch->pop_head, ch->push_head};
+    ch->pop_head = ch->pop_tail = NULL;
+    ch->push_head = ch->push_tail = NULL;
+    for (int i = 0; i < 2; i++) {
+        ChanWaiter *w = parked[i];
+        while (w != NULL) {
+            ChanWaiter *next = w->next;
+            w->status = LFQ_CLOSED;
+            chan_resume(ch, w);
+            w = next;
+        }
+    }
+    bq_destroy(&ch->q);
+}
+
+// Every park and every queue change that a parked waiter could use ends in
+// a call here. Only the caller that moves the counter off 0 dispatches; the
+// others just leave a request, and the dispatcher keeps making passes until
+// no request arrived during the last one, so none is lost. Callbacks run
+// inline re-enter as plain requests instead of recursing.
+static void chan_dispatch(AsyncChannel *ch) {
+    if (LFQ_FETCH_ADD(&ch->dispatch, 1, LFQ_SEQ) != 0) return;
+    int seen = 1;
+    for (;;) {
+        chan_collect(&ch->pop_inbox, &ch->pop_head, &ch->pop_tail);
+        chan_collect(&ch->push_inbox, &ch->push_head, &ch->push_tail);
+        int progress;
+        do {
+            progress = 0;
+            while (ch->pop_head != NULL && bq_dequeue(&ch->q, &ch->pop_head->value)) {
+                ChanWaiter *w = ch->pop_head;
+                ch->pop_head = w->next;
+                if (ch->pop_head == NULL) ch->pop_tail = NULL;
+                LFQ_FETCH_SUB(&ch->pop_parked, 1, LFQ_SEQ);
+                chan_resume(ch, w);
+                progress = 1;
+            }
+            while (ch->push_head != NULL && bq_try_enqueue(&ch->q, ch->push_head->value)) {
+                ChanWaiter *w = ch->push_head;
+                ch->push_head = w->next;
+                if (ch->push_head == NULL) ch->push_tail = NULL;
+                LFQ_FETCH_SUB(&ch->push_parked, 1, LFQ_SEQ);
+                chan_resume(ch, w);
+                progress = 1;
+            }
+        } while (progress);
+        if (LFQ_CAS(&ch->dispatch, &seen, 0, LFQ_SEQ)) return;
+    }
+}
+
+// Pops an item into *out_value and returns 1 if one is ready and no earlier
+// popper is parked (they go first); 0 otherwise, without parking
+int chan_try_pop(AsyncChannel *ch, int *out_value) {
+    if (LFQ_LOAD(&ch->pop_parked, LFQ_SEQ) != 0 || !bq_dequeue(&ch->q, out_value)) return 0;
+    // The dequeue may free a slot a pusher waits for
+    if (LFQ_LOAD(&ch->push_parked, LFQ_SEQ) != 0) chan_dispatch(ch);
+    return 1;
+}
+
+// Pushes value and returns 1 if there is room and no earlier pusher is
+// parked; 0 otherwise, without parking
+int chan_try_push(AsyncChannel *ch, int value) {
+    if (LFQ_LOAD(&ch->push_parked, LFQ_SEQ) != 0 || !bq_try_enqueue(&ch->q, value)) return 0;
+    if (LFQ_LOAD(&ch->pop_parked, LFQ_SEQ) != 0) chan_dispatch(ch);
+    return 1;
+}
+
+// Pops an item into *out_value and returns 1, or parks w and returns 0; w's
+// resume callback then runs once with the item in w->value. Without an
+// executor the callback may run before this returns, nested in this call.
+int chan_pop_async(AsyncChannel *ch, int *out_value, ChanWaiter *w, void (*resume)(ChanWaiter *)) {
+    if (chan_try_pop(ch, out_value)) return 1;
+    w->resume = resume;
+    w->status = LFQ_OK;
+    LFQ_FETCH_ADD(&ch->pop_parked, 1, LFQ_SEQ);
+    waiter_list_push(&ch->pop_inbox, w, w);
+    chan_dispatch(ch);
+    return 0;
+}
+
+// Pushes value and returns 1, or parks w and returns 0; the callback runs
+// once the value is in the channel.
+int chan_push_async(AsyncChannel *ch, int value, ChanWaiter *w, void (*resume)(ChanWaiter *)) {
+    if (chan_try_push(ch, value)) return 1;
+    w->resume = resume;
+    w->value = value;
+    w->status = LFQ_OK;
+    LFQ_FETCH_ADD(&ch->push_parked, 1, LFQ_SEQ);
+    waiter_list_push(&ch->push_inbox, w, w);
+    chan_dispatch(ch);
+    return 0;
+}
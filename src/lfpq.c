@@ -0,0 +1,193 @@
+// lfpq.c
+// Lock-free skiplist priority queue (Linden & Jonsson)
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Lock-free priority queue functions
+// =======================
+
+static inline PQNode *pq_ptr(uintptr_t p) {
+    return (PQNode *)(p & ~(uintptr_t)1);
+}
+
+static inline int pq_marked(uintptr_t p) {
+    return (int)(p & 1);
+}
+
+static PQNode *pq_new_node(int key, int value, int level) {
+    PQNode *n = node_alloc(sizeof(PQNode) + level * sizeof(_Atomic(uintptr_t)));
+    n->key = key;
+    n->value = value;
+    n->level = level;
+    atomic_init(&n->inserting, 0);
+    for (int i = 0; i < level; i++) {
+        atomic_init(&n->next[i], 0);
+    }
+    return n;
+}
+
+void lfpq_init(LFPriorityQueue *q) {
+    q->head = pq_new_node(INT_MIN, 0, PQ_MAX_LEVEL);
+    q->tail = pq_new_node(INT_MAX, 0, PQ_MAX_LEVEL);
+    for (int i = 0; i < PQ_MAX_LEVEL; i++) {
+        atomic_init(&q->head->next[i], (uintptr_t)q->tail);
+    }
+    atomic_init(&q->size, 0);
+}
+
+void lfpq_destroy(LFPriorityQueue *q) {
+    // Unlinked prefixes are owned by the retired list; free what is still reachable
+    PQNode *cur = q->head;
+    while (cur != NULL) {
+        PQNode *next = pq_ptr(LFQ_LOAD(&cur->next[0], LFQ_SEQ));
+        node_free(cur);
+        cur = next;
+    }
+}
+
+// Fills preds/succs for key, stepping over the deleted prefix on level 0.
+// Returns the last deleted node seen, which must not become an upper-level successor.
+static PQNode *pq_locate_preds(LFPriorityQueue *q, int key,
+                               PQNode **preds, PQNode **succs) {
+    PQNode *pred = q->head;
+    PQNode *del = NULL;
+
+    for (int i = PQ_MAX_LEVEL - 1; i >= 0; i--) {
+        uintptr_t raw = LFQ_LOAD(&pred->next[i], LFQ_SEQ);
+        int d = pq_marked(raw);
+        PQNode *cur = pq_ptr(raw);
+
+        while (cur->key < key || pq_marked(LFQ_LOAD(&cur->next[0], LFQ_SEQ)) || (i == 0 && d)) {
+            if (i == 0 && d) del = cur;
+            pred = cur;
+            raw = LFQ_LOAD(&pred->next[i], LFQ_SEQ);
+            d = pq_marked(raw);
+            cur = pq_ptr(raw);
+        }
+        preds[i] = pred;
+        succs[i] = cur;
+    }
+    return del;
+}
+
+void lfpq_insert(LFPriorityQueue *q, int key, int value) {
+    int level = 1;
+    while (level < PQ_MAX_LEVEL && (thread_rand() & 1)) level++;
+
+    PQNode *node = pq_new_node(key, value, level);
+    PQNode *preds[PQ_MAX_LEVEL];
+    PQNode *succs[PQ_MAX_LEVEL];
+    PQNode *del;
+    LFQ_STORE(&node->inserting, 1, LFQ_SEQ);
+
+    // Level 0 insertion is the linearization point
+    int retries = 0;
+    while (true) {
+        del = pq_locate_preds(q, key, preds, succs);
+        LFQ_STORE(&node->next[0], (uintptr_t)succs[0], LFQ_SEQ);
+        uintptr_t expected = (uintptr_t)succs[0];
+        if (LFQ_STAT_CAS(LFQ_OP_PQ_INSERT,
+                         LFQ_CAS(&preds[0]->next[0], &expected, (uintptr_t)node, LFQ_SEQ))) {
+            break;
+        }
+        retries++;
+    }
+    LFQ_FETCH_ADD(&q->size, 1, LFQ_SEQ);
+    LFQ_STAT_DONE(LFQ_OP_PQ_INSERT, retries);
+
+    // Upper levels are best effort; stop if the node got deleted meanwhile
+    int i = 1;
+    while (i < level) {
+        LFQ_STORE(&node->next[i], (uintptr_t)succs[i], LFQ_SEQ);
+        if (pq_marked(LFQ_LOAD(&node->next[0], LFQ_SEQ)) ||
+            pq_marked(LFQ_LOAD(&succs[i]->next[0], LFQ_SEQ)) || del == succs[i]) {
+            break;
+        }
+        uintptr_t expected = (uintptr_t)succs[i];
+        if (LFQ_CAS(&preds[i]->next[i], &expected, (uintptr_t)node, LFQ_SEQ)) {
+            i++;
+        } else {
+            del = pq_locate_preds(q, key, preds, succs);
+            if (succs[0] != node) break;
+        }
+    }
+    LFQ_STORE(&node->inserting, 0, LFQ_SEQ);
+}
+
+// Moves the head's upper-level pointers past the deleted prefix
+static void pq_restructure(LFPriorityQueue *q) {
+    PQNode *pred = q->head;
+    int i = PQ_MAX_LEVEL - 1;
+
+    while (i > 0) {
+        uintptr_t h = LFQ_LOAD(&q->head->next[i], LFQ_SEQ);
+        PQNode *cur = pq_ptr(LFQ_LOAD(&pred->next[i], LFQ_SEQ));
+
+        if (!pq_marked(LFQ_LOAD(&pq_ptr(h)->next[0], LFQ_SEQ))) {
+            i--;
+            continue;
+        }
+        while (pq_marked(LFQ_LOAD(&cur->next[0], LFQ_SEQ))) {
+            pred = cur;
+            cur = pq_ptr(LFQ_LOAD(&pred->next[i], LFQ_SEQ));
+        }
+        if (LFQ_CAS(&q->head->next[i], &h, LFQ_LOAD(&pred->next[i], LFQ_SEQ), LFQ_SEQ)) {
+            i--;
+        }
+    }
+}
+
+int lfpq_delete_min(LFPriorityQueue *q, int *out_key, int *out_value) {
+    PQNode *x = q->head;
+    PQNode *newhead = NULL;
+    uintptr_t obshead = LFQ_LOAD(&x->next[0], LFQ_SEQ);
+    uintptr_t nxt;
+    int offset = 0;
+
+    // Walk the deleted prefix and claim the first node by marking its predecessor.
+    // A fetch_or that finds the mark already set lost a race and counts as a retry.
+    int retries = 0;
+    do {
+        nxt = LFQ_LOAD(&x->next[0], LFQ_SEQ);
+        if (pq_ptr(nxt) == q->tail) {
+            LFQ_STAT_EMPTY(LFQ_OP_PQ_DELETE_MIN);
+            LFQ_STAT_DONE(LFQ_OP_PQ_DELETE_MIN, retries);
+            return 0; // Queue is empty
+        }
+        if (newhead == NULL && LFQ_LOAD(&x->inserting, LFQ_SEQ)) newhead = x;
+        if (!pq_marked(nxt)) {
+            nxt = LFQ_FETCH_OR(&x->next[0], 1, LFQ_SEQ);
+            if (!LFQ_STAT_CAS(LFQ_OP_PQ_DELETE_MIN, !pq_marked(nxt))) retries++;
+        }
+        offset++;
+        x = pq_ptr(nxt);
+    } while (pq_marked(nxt));
+    LFQ_STAT_DONE(LFQ_OP_PQ_DELETE_MIN, retries);
+
+    if (out_key) *out_key = x->key;
+    if (out_value) *out_value = x->value;
+    LFQ_FETCH_SUB(&q->size, 1, LFQ_SEQ);
+
+    if (newhead == NULL) newhead = x;
+    if (offset <= PQ_BOUND_OFFSET) return 1;
+    if (LFQ_LOAD(&q->head->next[0], LFQ_SEQ) != obshead) return 1;
+
+    // Batched physical deletion: one CAS cuts the whole prefix off
+    if (LFQ_CAS(&q->head->next[0], &obshead, (uintptr_t)newhead | 1, LFQ_SEQ)) {
+        pq_restructure(q);
+        PQNode *cur = pq_ptr(obshead);
+        while (cur != newhead) {
+            PQNode *next = pq_ptr(LFQ_LOAD(&cur->next[0], LFQ_SEQ));
+            retired_list_add(cur);
+            cur = next;
+        }
+    }
+    return 1;
+}
+
+int lfpq_size(LFPriorityQueue *q) {
+    return LFQ_LOAD(&q->size, LFQ_SEQ);
+}
@@ -0,0 +1,91 @@
+// lfq_internal.h
+// Helpers shared between the library sources but not part of the public
+// interface. They are hidden from the shared library's symbol table; the
+// white-box tests reach them through the static library.
+
+#ifndef LFQ_INTERNAL_H
+#define LFQ_INTERNAL_H
+
+#include "lfq.h"
+#include "lfq_atomic.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <time.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <errno.h>
+#include <malloc.h> // malloc_usable_size
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+
+#define LFQ_INTERNAL __attribute__((visibility("hidden")))
+
+// -------- Allocation (memory.c) -----
+LFQ_INTERNAL void *node_realloc(void *p, size_t size);
+LFQ_INTERNAL Node *new_node(int value);
+
+// -------- Cross-structure helpers -----
+LFQ_INTERNAL int lfqueue_enqueue_node(LFQueue *q, Node *node);        // lfqueue.c
+LFQ_INTERNAL int lfqueue_peek_stamp(LFQueue *q, uint64_t *stamp);     // lfqueue.c
+LFQ_INTERNAL unsigned int thread_rand(void);                          // multiqueue.c
+LFQ_INTERNAL uint32_t shm_node_alloc(ShmRegion *r);                   // shmqueue.c
+
+// -------- Statistics hooks (stats.c) -----
+#ifdef LFQ_STATS
+
+typedef struct LFQStatsBlock {
+    _Atomic(uint64_t) counters[LFQ_NUM_OPS][sizeof(LFQOpStats) / sizeof(uint64_t)];
+    struct LFQStatsBlock *next;
+} LFQStatsBlock;
+
+LFQ_INTERNAL LFQStatsBlock *lfq_stats_block(void);
+
+// Only the owning thread writes its block, so no read-modify-write is needed
+static inline void lfq_stat_add(int op, size_t field, uint64_t n) {
+    _Atomic(uint64_t) *c = &lfq_stats_block()->counters[op][field / sizeof(uint64_t)];
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static inline int lfq_stat_cas(int op, int ok) {
+    lfq_stat_add(op, offsetof(LFQOpStats, cas_attempts), 1);
+    if (!ok) lfq_stat_add(op, offsetof(LFQOpStats, cas_failures), 1);
+    return ok;
+}
+
+static inline void lfq_stat_done(int op, int retries) {
+    int bucket = 0;
+    while (retries > 0 && bucket < LFQ_RETRY_BUCKETS - 1) {
+        retries >>= 1;
+        bucket++;
+    }
+    lfq_stat_add(op, offsetof(LFQOpStats, ops), 1);
+    lfq_stat_add(op, offsetof(LFQOpStats, retries) + bucket * sizeof(uint64_t), 1);
+}
+
+#define LFQ_STAT_CAS(op, cas) lfq_stat_cas((op), (cas))
+#define LFQ_STAT_HELP(op) lfq_stat_add((op), offsetof(LFQOpStats, tail_helps), 1)
+#define LFQ_STAT_EMPTY(op) lfq_stat_add((op), offsetof(LFQOpStats, empty_returns), 1)
+#define LFQ_STAT_DONE(op, retries) lfq_stat_done((op), (retries))
+
+#else
+
+#define LFQ_STAT_CAS(op, cas) (cas)
+#define LFQ_STAT_HELP(op) ((void)0)
+#define LFQ_STAT_EMPTY(op) ((void)0)
+#define LFQ_STAT_DONE(op, retries) ((void)(retries))
+
+#endif
+
+#endif // LFQ_INTERNAL_H
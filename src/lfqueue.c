@@ -0,0 +1,257 @@
+// lfqueue.c
+// Michael & Scott lock-free queue, with closing and eventfd notification
+//
+// Memory orders (see lfq_atomic.h):
+//   - head, tail and next are loaded with acquire, because the node they
+//     point to is dereferenced next
+//   - the CAS that links a node is release, publishing the node's value and
+//     stamp to the consumer that loads next with acquire
+//   - tail/head swings are release so the next reader of the pointer is
+//     ordered after the writes that made the node reachable
+//   - the "still current" re-reads and size are relaxed: a stale answer only
+//     costs a retry or an approximate count
+//   - the linking CAS and the armed load stay seq_cst; they are one side of
+//     the eventfd handshake (see Event-loop notification below)
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Lock-free queue functions
+// =======================
+
+// Linked after the last item by lfqueue_close. Shared by every queue: its
+// next stays NULL because enqueue refuses to link past it and dequeue never
+// makes it the head.
+static Node lfq_closed_node;
+
+void lfqueue_init(LFQueue *q) {
+    Node *dummy = new_node(0);
+    atomic_init(&q->head, dummy);
+    atomic_init(&q->tail, dummy);
+    atomic_init(&q->size, 0);
+    atomic_init(&q->armed, 0);
+    q->notify_fd = -1;
+}
+
+void lfqueue_destroy(LFQueue *q) {
+    if (q->notify_fd >= 0) close(q->notify_fd);
+    Node *cur = atomic_load_explicit(&q->head, LFQ_RELAXED);
+    while (cur != NULL && cur != &lfq_closed_node) {
+        Node *next = atomic_load_explicit(&cur->next, LFQ_RELAXED);
+        node_free(cur);
+        cur = next;
+    }
+}
+
+static void lfqueue_signal(LFQueue *q);
+
+// Returns 0 without linking if the queue is closed
+int lfqueue_enqueue_node(LFQueue *q, Node *node) {
+    Node *tail;
+    Node *next;
+
+    for (int retries = 0;; retries++) {
+        tail = LFQ_LOAD(&q->tail, LFQ_ACQUIRE);
+        next = LFQ_LOAD(&tail->next, LFQ_ACQUIRE);
+
+        if (tail == &lfq_closed_node || next == &lfq_closed_node) {
+            LFQ_STAT_DONE(LFQ_OP_ENQUEUE, retries);
+            return 0;
+        }
+        if (tail == LFQ_LOAD(&q->tail, LFQ_RELAXED)) {
+            if (next == NULL) {
+                // seq_cst rather than release: the armed load below must not
+                // move ahead of it
+                if (LFQ_STAT_CAS(LFQ_OP_ENQUEUE, LFQ_CAS(&tail->next, &next, node, LFQ_SEQ))) {
+                    LFQ_CAS(&q->tail, &tail, node, LFQ_RELEASE);
+                    LFQ_FETCH_ADD(&q->size, 1, LFQ_RELAXED);
+                    LFQ_STAT_DONE(LFQ_OP_ENQUEUE, retries);
+                    // seq_cst load after the linking CAS; pairs with lfqueue_rearm
+                    if (LFQ_LOAD(&q->armed, LFQ_SEQ)) lfqueue_signal(q);
+                    return 1;
+                }
+            } else {
+                LFQ_STAT_HELP(LFQ_OP_ENQUEUE);
+                LFQ_CAS(&q->tail, &tail, next, LFQ_RELEASE);
+            }
+        }
+    }
+}
+
+// Returns 0 once the queue has been closed
+int lfqueue_enqueue(LFQueue *q, int value) {
+    Node *node = new_node(value);
+    if (lfqueue_enqueue_node(q, node)) return 1;
+    node_free(node);
+    return 0;
+}
+
+// LFQ_OK with the front item, LFQ_EMPTY, or LFQ_CLOSED once the queue is
+// closed and every item enqueued before the close has been taken
+int lfqueue_try_dequeue(LFQueue *q, int *out_value) {
+    Node *head;
+    Node *tail;
+    Node *next;
+
+    for (int retries = 0;; retries++) {
+        head = LFQ_LOAD(&q->head, LFQ_ACQUIRE);
+        // Only compared and swung, never dereferenced. The acquire on head
+        // already keeps it from being older than the tail the last dequeuer saw.
+        tail = LFQ_LOAD(&q->tail, LFQ_RELAXED);
+        next = LFQ_LOAD(&head->next, LFQ_ACQUIRE);
+
+        if (head == LFQ_LOAD(&q->head, LFQ_RELAXED)) {
+            if (next == &lfq_closed_node) {
+                LFQ_STAT_EMPTY(LFQ_OP_DEQUEUE);
+                LFQ_STAT_DONE(LFQ_OP_DEQUEUE, retries);
+                return LFQ_CLOSED;
+            }
+            if (head == tail) {
+                if (next == NULL) {
+                    LFQ_STAT_EMPTY(LFQ_OP_DEQUEUE);
+                    LFQ_STAT_DONE(LFQ_OP_DEQUEUE, retries);
+                    return LFQ_EMPTY; // Queue is empty
+                }
+                LFQ_STAT_HELP(LFQ_OP_DEQUEUE);
+                LFQ_CAS(&q->tail, &tail, next, LFQ_RELEASE);
+            } else {
+                if (next == NULL) {
+                    LFQ_STAT_EMPTY(LFQ_OP_DEQUEUE);
+                    LFQ_STAT_DONE(LFQ_OP_DEQUEUE, retries);
+                    return LFQ_EMPTY;
+                }
+                int value = next->value;
+                
+                if (LFQ_STAT_CAS(LFQ_OP_DEQUEUE, LFQ_CAS(&q->head, &head, next, LFQ_RELEASE))) {
+                    if (out_value) {
+                        *out_value = value;
+                    }
+                    LFQ_FETCH_SUB(&q->size, 1, LFQ_RELAXED);
+                    // Deferred reclamation instead of immediate free
+                    retired_list_add(head);
+                    LFQ_STAT_DONE(LFQ_OP_DEQUEUE, retries);
+                    return LFQ_OK;
+                }
+            }
+        }
+    }
+}
+
+// 1 with the front item, 0 if the queue is empty (or closed and drained)
+int lfqueue_dequeue(LFQueue *q, int *out_value) {
+    return lfqueue_try_dequeue(q, out_value) == LFQ_OK;
+}
+
+// Links the closed sentinel after the last item, so later enqueues fail and
+// consumers see LFQ_CLOSED once they have drained what is left. Wakes an
+// eventfd consumer whether or not it is armed. Closing twice is harmless.
+void lfqueue_close(LFQueue *q) {
+    for (;;) {
+        Node *tail = LFQ_LOAD(&q->tail, LFQ_ACQUIRE);
+        Node *next = LFQ_LOAD(&tail->next, LFQ_ACQUIRE);
+        if (tail == &lfq_closed_node || next == &lfq_closed_node) break;
+        if (tail != LFQ_LOAD(&q->tail, LFQ_RELAXED)) continue;
+        if (next != NULL) {
+            LFQ_CAS(&q->tail, &tail, next, LFQ_RELEASE);
+        } else if (LFQ_CAS(&tail->next, &next, &lfq_closed_node, LFQ_RELEASE)) {
+            LFQ_CAS(&q->tail, &tail, &lfq_closed_node, LFQ_RELEASE);
+            break;
+        }
+    }
+    if (q->notify_fd >= 0) {
+        LFQ_STORE(&q->armed, 1, LFQ_SEQ);
+        lfqueue_signal(q);
+    }
+}
+
+int lfqueue_is_closed(LFQueue *q) {
+    Node *tail = LFQ_LOAD(&q->tail, LFQ_ACQUIRE);
+    return tail == &lfq_closed_node || LFQ_LOAD(&tail->next, LFQ_ACQUIRE) == &lfq_closed_node;
+}
+
+int lfqueue_size(LFQueue *q) {
+    return LFQ_LOAD(&q->size, LFQ_RELAXED);
+}
+
+// Reads the stamp of the front item without removing it. Dequeued nodes are
+// retired rather than freed, so dereferencing a stale head is still safe.
+int lfqueue_peek_stamp(LFQueue *q, uint64_t *stamp) {
+    Node *head = LFQ_LOAD(&q->head, LFQ_ACQUIRE);
+    Node *next = LFQ_LOAD(&head->next, LFQ_ACQUIRE);
+    if (next == NULL) return 0;
+    *stamp = next->stamp;
+    return 1;
+}
+
+// -------- Event-loop notification -----
+// An eventfd that becomes readable when an armed queue receives an item, so
+// epoll consumers can sleep instead of polling. Only the producer that flips
+// armed from 1 to 0 writes the eventfd; every other enqueue pays one load.
+// The consumer stores armed and then checks for items, the producer links
+// its item and then loads armed, both seq_cst, so at least one of them sees
+// the other and a wakeup cannot be lost. This is the one place that needs
+// store-to-load ordering, so these accesses are the only seq_cst ones left.
+
+static void lfqueue_signal(LFQueue *q) {
+    if (LFQ_EXCHANGE(&q->armed, 0, LFQ_SEQ) == 1) {
+        uint64_t one = 1;
+        // EAGAIN means the counter is saturated, which leaves the fd readable anyway
+        if (write(q->notify_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            perror("write eventfd");
+        }
+    }
+}
+
+// Items or the closed sentinel: either way the consumer has work
+static int lfqueue_has_items(LFQueue *q) {
+    // Retired heads stay allocated, so a stale head is safe to read
+    return LFQ_LOAD(&LFQ_LOAD(&q->head, LFQ_SEQ)->next, LFQ_SEQ) != NULL;
+}
+
+// Returns the queue's eventfd, creating and arming it on first use, or -1
+// (errno set) if eventfd is unavailable. Call before consumers start; the fd
+// is closed by lfqueue_destroy.
+int lfqueue_notify_fd(LFQueue *q) {
+#ifdef __linux__
+    if (q->notify_fd < 0) {
+        q->notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (q->notify_fd < 0) return -1;
+        LFQ_STORE(&q->armed, 1, LFQ_SEQ);
+        if (lfqueue_has_items(q)) lfqueue_signal(q);
+    }
+    return q->notify_fd;
+#else
+    (void)q;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+// Dequeues up to max items into out. Returns how many were taken, or -1 if
+// the queue is closed and nothing is left.
+int lfqueue_drain(LFQueue *q, int *out, int max) {
+    int n = 0;
+    int status = LFQ_OK;
+    while (n < max && (status = lfqueue_try_dequeue(q, &out[n])) == LFQ_OK) {
+        n++;
+    }
+    return (n == 0 && status == LFQ_CLOSED) ? -1 : n;
+}
+
+// Called by the consumer once a drain came up short. Clears the eventfd and
+// arms the queue again. Returns 1 if items arrived in the meantime (keep
+// draining), 0 if it is safe to go back to epoll_wait.
+int lfqueue_rearm(LFQueue *q) {
+    uint64_t count;
+    if (read(q->notify_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        perror("read eventfd");
+    }
+    LFQ_STORE(&q->armed, 1, LFQ_SEQ);
+    if (!lfqueue_has_items(q)) return 0;
+    // Take the arm back; if a producer already did, the fd is readable and
+    // the next epoll_wait returns at once
+    LFQ_STORE(&q->armed, 0, LFQ_SEQ);
+    return 1;
+}
@@ -0,0 +1,109 @@
+// lfstack.c
+// Treiber stack with an optional elimination array
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Lock-free stack functions
+// =======================
+
+void lfstack_init(LFStack *s, int use_elimination) {
+    atomic_init(&s->top, NULL);
+    atomic_init(&s->size, 0);
+    s->use_elimination = use_elimination;
+    for (int i = 0; i < ELIM_SLOTS; i++) {
+        atomic_init(&s->elim[i].offer, NULL);
+    }
+}
+
+void lfstack_destroy(LFStack *s) {
+    Node *cur = LFQ_LOAD(&s->top, LFQ_SEQ);
+    while (cur != NULL) {
+        Node *next = LFQ_LOAD(&cur->next, LFQ_SEQ);
+        node_free(cur);
+        cur = next;
+    }
+}
+
+// Parks node in a slot; returns 1 if a pop took it before we withdrew it
+static int lfstack_offer_push(LFStack *s, Node *node) {
+    _Atomic(Node *) *slot = &s->elim[thread_rand() % ELIM_SLOTS].offer;
+    Node *expected = NULL;
+
+    if (!LFQ_CAS(slot, &expected, node, LFQ_SEQ)) return 0;
+    for (int i = 0; i < ELIM_SPINS; i++) {
+        if (LFQ_LOAD(slot, LFQ_SEQ) != node) return 1;
+    }
+    expected = node;
+    return !LFQ_CAS(slot, &expected, NULL, LFQ_SEQ);
+}
+
+// Takes a parked node from a random slot, or returns NULL
+static Node *lfstack_take_offer(LFStack *s) {
+    _Atomic(Node *) *slot = &s->elim[thread_rand() % ELIM_SLOTS].offer;
+
+    for (int i = 0; i < ELIM_SPINS; i++) {
+        Node *n = LFQ_LOAD(slot, LFQ_SEQ);
+        if (n != NULL && LFQ_CAS(slot, &n, NULL, LFQ_SEQ)) {
+            return n;
+        }
+    }
+    return NULL;
+}
+
+void lfstack_push(LFStack *s, int value) {
+    Node *node = new_node(value);
+
+    for (int retries = 0;; retries++) {
+        Node *top = LFQ_LOAD(&s->top, LFQ_SEQ);
+        LFQ_STORE(&node->next, top, LFQ_SEQ);
+        if (LFQ_STAT_CAS(LFQ_OP_PUSH, LFQ_CAS(&s->top, &top, node, LFQ_SEQ))) {
+            LFQ_FETCH_ADD(&s->size, 1, LFQ_SEQ);
+            LFQ_STAT_DONE(LFQ_OP_PUSH, retries);
+            return;
+        }
+        if (s->use_elimination && lfstack_offer_push(s, node)) {
+            LFQ_STAT_DONE(LFQ_OP_PUSH, retries);
+            return; // Handed directly to a concurrent pop
+        }
+    }
+}
+
+int lfstack_pop(LFStack *s, int *out_value) {
+    for (int retries = 0;; retries++) {
+        Node *top = LFQ_LOAD(&s->top, LFQ_SEQ);
+        if (top == NULL) {
+            LFQ_STAT_EMPTY(LFQ_OP_POP);
+            LFQ_STAT_DONE(LFQ_OP_POP, retries);
+            return 0; // Stack is empty
+        }
+        Node *next = LFQ_LOAD(&top->next, LFQ_SEQ);
+        if (LFQ_STAT_CAS(LFQ_OP_POP, LFQ_CAS(&s->top, &top, next, LFQ_SEQ))) {
+            if (out_value) {
+                *out_value = top->value;
+            }
+            LFQ_FETCH_SUB(&s->size, 1, LFQ_SEQ);
+            // Other poppers may still read top->next
+            retired_list_add(top);
+            LFQ_STAT_DONE(LFQ_OP_POP, retries);
+            return 1;
+        }
+        if (s->use_elimination) {
+            Node *n = lfstack_take_offer(s);
+            if (n != NULL) {
+                if (out_value) {
+                    *out_value = n->value;
+                }
+                node_free(n); // Never reachable from top, so no deferral needed
+                LFQ_STAT_DONE(LFQ_OP_POP, retries);
+                return 1;
+            }
+        }
+    }
+}
+
+int lfstack_size(LFStack *s) {
+    return LFQ_LOAD(&s->size, LFQ_SEQ);
+}
@@ -0,0 +1,68 @@
+// lockedpq.c
+// Mutex-protected binary heap, the priority queue baseline
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Locked priority queue functions
+// =======================
+
+void lockedpq_init(LockedPQ *q) {
+    q->capacity = 1024;
+    q->size = 0;
+    q->keys = node_alloc(q->capacity * sizeof(int));
+    q->values = node_alloc(q->capacity * sizeof(int));
+    pthread_mutex_init(&q->lock, NULL);
+}
+
+void lockedpq_destroy(LockedPQ *q) {
+    node_free(q->keys);
+    node_free(q->values);
+    pthread_mutex_destroy(&q->lock);
+}
+
+void lockedpq_insert(LockedPQ *q, int key, int value) {
+    pthread_mutex_lock(&q->lock);
+    if (q->size == q->capacity) {
+        q->capacity *= 2;
+        q->keys = node_realloc(q->keys, q->capacity * sizeof(int));
+        q->values = node_realloc(q->values, q->capacity * sizeof(int));
+    }
+    int i = q->size++;
+    while (i > 0 && q->keys[(i - 1) / 2] > key) {
+        q->keys[i] = q->keys[(i - 1) / 2];
+        q->values[i] = q->values[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    q->keys[i] = key;
+    q->values[i] = value;
+    pthread_mutex_unlock(&q->lock);
+}
+
+int lockedpq_delete_min(LockedPQ *q, int *out_key, int *out_value) {
+    pthread_mutex_lock(&q->lock);
+    if (q->size == 0) {
+        pthread_mutex_unlock(&q->lock);
+        return 0;
+    }
+    if (out_key) *out_key = q->keys[0];
+    if (out_value) *out_value = q->values[0];
+
+    int key = q->keys[--q->size];
+    int value = q->values[q->size];
+    int i = 0;
+    while (2 * i + 1 < q->size) {
+        int child = 2 * i + 1;
+        if (child + 1 < q->size && q->keys[child + 1] < q->keys[child]) child++;
+        if (q->keys[child] >= key) break;
+        q->keys[i] = q->keys[child];
+        q->values[i] = q->values[child];
+        i = child;
+    }
+    q->keys[i] = key;
+    q->values[i] = value;
+    pthread_mutex_unlock(&q->lock);
+    return 1;
+}
@@ -0,0 +1,61 @@
+// lockedqueue.c
+// Mutex-protected linked queue, the baseline for the benchmarks
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Locked queue functions
+// =======================
+
+void lockedqueue_init(LockedQueue *q) {
+    Node *dummy = new_node(0);
+    q->head = dummy;
+    q->tail = dummy;
+    q->size = 0;
+    pthread_mutex_init(&q->lock, NULL);
+}
+
+void lockedqueue_destroy(LockedQueue *q) {
+    pthread_mutex_lock(&q->lock);
+    Node *cur = q->head;
+    while (cur != NULL) {
+        Node *next = atomic_load(&cur->next);
+        node_free(cur);
+        cur = next;
+    }
+    pthread_mutex_unlock(&q->lock);
+    pthread_mutex_destroy(&q->lock);
+}
+
+void lockedqueue_enqueue(LockedQueue *q, int value) {
+    Node *node = new_node(value);
+    pthread_mutex_lock(&q->lock);
+    atomic_store(&q->tail->next, node);
+    q->tail = node;
+    q->size++;
+    pthread_mutex_unlock(&q->lock);
+}
+
+int lockedqueue_dequeue(LockedQueue *q, int *out_value) {
+    pthread_mutex_lock(&q->lock);
+    Node *head = q->head;
+    Node *next = atomic_load(&head->next);
+
+    if (next == NULL) {
+        pthread_mutex_unlock(&q->lock);
+        return 0;
+    }
+
+    int value = next->value;
+    q->head = next;
+    q->size--;
+    pthread_mutex_unlock(&q->lock);
+
+    node_free(head);
+    if (out_value) {
+        *out_value = value;
+    }
+    return 1;
+}
@@ -0,0 +1,164 @@
+// memory.c
+// Allocation accounting and the retired-node list shared by every structure
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Utility functions
+// =======================
+
+// Checked malloc behind node_alloc
+static void *xmalloc(size_t size) {
+    void *p = malloc(size);
+    if (!p) {
+        perror("malloc");
+        exit(1);
+    }
+    return p;
+}
+
+// -------- Memory telemetry -----
+// Every queue allocation (nodes, slot arrays, heaps) goes through node_alloc
+// and node_free, which count calls and malloc_usable_size bytes into a
+// per-thread block. Only the owner writes a block, so the hot path has no
+// shared writes; mem_stats_snapshot sums the blocks. A node may be freed by a
+// different thread than allocated it, so only the sums are meaningful.
+enum { MEM_ALLOC_CALLS, MEM_FREE_CALLS, MEM_ALLOC_BYTES, MEM_FREE_BYTES, MEM_NUM_COUNTERS };
+
+typedef struct MemStatsBlock {
+    _Atomic(uint64_t) counters[MEM_NUM_COUNTERS];
+    struct MemStatsBlock *next;
+} MemStatsBlock;
+
+static MemStatsBlock *mem_stats_blocks = NULL;
+static pthread_mutex_t mem_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local MemStatsBlock *mem_stats_local;
+
+static inline void mem_count(int counter, uint64_t n) {
+    if (mem_stats_local == NULL) {
+        MemStatsBlock *b = calloc(1, sizeof(MemStatsBlock));
+        if (!b) {
+            perror("calloc");
+            exit(1);
+        }
+        pthread_mutex_lock(&mem_stats_lock);
+        b->next = mem_stats_blocks;
+        mem_stats_blocks = b;
+        pthread_mutex_unlock(&mem_stats_lock);
+        mem_stats_local = b;
+    }
+    _Atomic(uint64_t) *c = &mem_stats_local->counters[counter];
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+// Shared allocation path for every node type (queue, skiplist, stack)
+void *node_alloc(size_t size) {
+    void *p = xmalloc(size);
+    mem_count(MEM_ALLOC_CALLS, 1);
+    mem_count(MEM_ALLOC_BYTES, malloc_usable_size(p));
+    return p;
+}
+
+void node_free(void *p) {
+    if (p == NULL) return;
+    mem_count(MEM_FREE_CALLS, 1);
+    mem_count(MEM_FREE_BYTES, malloc_usable_size(p));
+    free(p);
+}
+
+// Growing an array counts as one allocator call
+void *node_realloc(void *p, size_t size) {
+    size_t old = p ? malloc_usable_size(p) : 0;
+    p = realloc(p, size);
+    if (!p) {
+        perror("realloc");
+        exit(1);
+    }
+    mem_count(MEM_ALLOC_CALLS, 1);
+    mem_count(MEM_FREE_CALLS, 1);
+    mem_count(MEM_ALLOC_BYTES, malloc_usable_size(p));
+    mem_count(MEM_FREE_BYTES, old);
+    return p;
+}
+
+Node *new_node(int value) {
+    Node *n = (Node *)node_alloc(sizeof(Node));
+    n->value = value;
+    n->stamp = 0;
+    atomic_init(&n->next, NULL);
+    return n;
+}
+
+RetiredList retired_list;
+
+void retired_list_init() {
+    retired_list.count = 0;
+    pthread_mutex_init(&retired_list.lock, NULL);
+}
+
+void retired_list_add(void *node) {
+    pthread_mutex_lock(&retired_list.lock);
+    retired_list.total++;
+    if (retired_list.count < MAX_RETIRED) {
+        retired_list.nodes[retired_list.count++] = node;
+        if (retired_list.count > retired_list.peak) retired_list.peak = retired_list.count;
+    } else {
+        retired_list.dropped++;
+    }
+    pthread_mutex_unlock(&retired_list.lock);
+}
+
+void retired_list_cleanup() {
+    pthread_mutex_lock(&retired_list.lock);
+    for (int i = 0; i < retired_list.count; i++) {
+        node_free(retired_list.nodes[i]);
+    }
+    retired_list.count = 0;
+    pthread_mutex_unlock(&retired_list.lock);
+    pthread_mutex_destroy(&retired_list.lock);
+}
+
+static long current_rss_kb(void) {
+    long pages = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f == NULL) return 0;
+    if (fscanf(f, "%*s %ld", &pages) != 1) pages = 0;
+    fclose(f);
+    return pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+void mem_stats_snapshot(MemStats *out) {
+    uint64_t sum[MEM_NUM_COUNTERS] = {0};
+    pthread_mutex_lock(&mem_stats_lock);
+    for (MemStatsBlock *b = mem_stats_blocks; b != NULL; b = b->next) {
+        for (int i = 0; i < MEM_NUM_COUNTERS; i++) {
+            sum[i] += atomic_load_explicit(&b->counters[i], memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&mem_stats_lock);
+
+    memset(out, 0, sizeof(*out));
+    out->alloc_calls = (long long)sum[MEM_ALLOC_CALLS];
+    out->free_calls = (long long)sum[MEM_FREE_CALLS];
+    out->live_allocs = out->alloc_calls - out->free_calls;
+    out->live_bytes = (long long)(sum[MEM_ALLOC_BYTES] - sum[MEM_FREE_BYTES]);
+    // Plain reads: the list may be mid-update, which only skews a sample
+    out->retired = retired_list.count;
+    out->peak_retired = retired_list.peak;
+    out->retired_total = retired_list.total;
+    out->dropped = retired_list.dropped;
+    out->rss_kb = current_rss_kb();
+
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) out->peak_rss_kb = ru.ru_maxrss;
+}
+
+// Restarts the per-run retired-list counters (allocation counters are
+// cumulative; take a snapshot before and after and subtract)
+void mem_stats_reset(void) {
+    retired_list.peak = retired_list.count;
+    retired_list.total = 0;
+    retired_list.dropped = 0;
+}
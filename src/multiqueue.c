@@ -0,0 +1,107 @@
+// multiqueue.c
+// Relaxed sharded queue over LFQueue shards
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Relaxed MultiQueue functions
+// =======================
+
+// Per-thread xorshift state (shard selection, skiplist levels)
+static _Thread_local unsigned int thread_seed;
+
+unsigned int thread_rand(void) {
+    unsigned int x = thread_seed;
+    if (x == 0) x = (unsigned int)(uintptr_t)&thread_seed | 1u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    thread_seed = x;
+    return x;
+}
+
+void multiqueue_init(MultiQueue *mq, int num_shards) {
+    if (num_shards < 1) num_shards = 1;
+    mq->shards = node_alloc(num_shards * sizeof(LFQueue));
+    for (int i = 0; i < num_shards; i++) {
+        lfqueue_init(&mq->shards[i]);
+    }
+    mq->num_shards = num_shards;
+}
+
+void multiqueue_destroy(MultiQueue *mq) {
+    for (int i = 0; i < mq->num_shards; i++) {
+        lfqueue_destroy(&mq->shards[i]);
+    }
+    node_free(mq->shards);
+}
+
+// Small per-thread id in the low bits of every stamp, so two enqueues that
+// read the same clock value still order consistently
+static _Thread_local unsigned int thread_tag;
+static _Atomic(unsigned int) next_thread_tag;
+
+// Enqueue time from the calling thread's own clock. Stamps from different
+// cores are only as comparable as the TSCs are synchronized (invariant TSC
+// on current x86); a small skew just adds to the relaxation.
+static uint64_t mq_stamp(void) {
+    if (thread_tag == 0) {
+        thread_tag = atomic_fetch_add_explicit(&next_thread_tag, 1, memory_order_relaxed) + 1;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t now = __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+    // The shift wraps after 2^56 ticks; dequeue compares stamps wrap-safely
+    return (now << 8) | (thread_tag & 0xff);
+}
+
+// Returns 0 if the chosen shard has been closed
+int multiqueue_enqueue(MultiQueue *mq, int value) {
+    Node *node = new_node(value);
+    node->stamp = mq_stamp();
+    if (lfqueue_enqueue_node(&mq->shards[thread_rand() % mq->num_shards], node)) return 1;
+    node_free(node);
+    return 0;
+}
+
+int multiqueue_dequeue(MultiQueue *mq, int *out_value) {
+    int k = mq->num_shards;
+
+    // Power-of-two-choices: take from whichever shard has the older front
+    for (int attempt = 0; attempt < k; attempt++) {
+        int a = thread_rand() % k;
+        int b = thread_rand() % k;
+        uint64_t sa, sb;
+        int has_a = lfqueue_peek_stamp(&mq->shards[a], &sa);
+        int has_b = lfqueue_peek_stamp(&mq->shards[b], &sb);
+
+        if (!has_a && !has_b) continue;
+        int pick = (!has_b || (has_a && (int64_t)(sa - sb) <= 0)) ? a : b;
+        if (lfqueue_dequeue(&mq->shards[pick], out_value)) {
+            return 1;
+        }
+    }
+
+    // Sweep every shard so an empty result means all shards were seen empty
+    int start = thread_rand() % k;
+    for (int i = 0; i < k; i++) {
+        if (lfqueue_dequeue(&mq->shards[(start + i) % k], out_value)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int multiqueue_size(MultiQueue *mq) {
+    int total = 0;
+    for (int i = 0; i < mq->num_shards; i++) {
+        total += lfqueue_size(&mq->shards[i]);
+    }
+    return total;
+}
@@ -0,0 +1,137 @@
+// ring.c
+// Disruptor-style multicast ring
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Multicast ring functions
+// =======================
+
+// Spin briefly, then yield so waiting never starves the thread we wait on
+static inline void ring_pause(int *spins) {
+    if (++(*spins) > 64) {
+        sched_yield();
+        *spins = 0;
+    }
+}
+
+void ring_init(MulticastRing *r, int capacity, int multi_producer) {
+    int shift = 0;
+    while ((1 << shift) < capacity) shift++;
+
+    r->capacity = (int64_t)1 << shift;
+    r->mask = r->capacity - 1;
+    r->shift = shift;
+    r->multi_producer = multi_producer;
+    r->slots = node_alloc(r->capacity * sizeof(int));
+    r->published = node_alloc(r->capacity * sizeof(_Atomic(int32_t)));
+    for (int64_t i = 0; i < r->capacity; i++) {
+        atomic_init(&r->published[i], -1);
+    }
+    r->next_claim = 0;
+    atomic_init(&r->claim, 0);
+    atomic_init(&r->cursor, -1);
+    atomic_init(&r->gate_cache, -1);
+    r->num_consumers = 0;
+}
+
+void ring_destroy(MulticastRing *r) {
+    node_free(r->slots);
+    node_free((void *)r->published);
+}
+
+// Registers a consumer that may only read events its dependencies have
+// finished with. Must be called before any producer or consumer starts.
+int ring_add_consumer(MulticastRing *r, const int *deps, int num_deps) {
+    if (r->num_consumers == RING_MAX_CONSUMERS || num_deps > RING_MAX_DEPS) {
+        return -1;
+    }
+    int id = r->num_consumers++;
+    RingConsumer *c = &r->consumers[id];
+    atomic_init(&c->seq, -1);
+    c->num_deps = num_deps;
+    for (int i = 0; i < num_deps; i++) {
+        c->deps[i] = deps[i];
+    }
+    return id;
+}
+
+static int64_t ring_min_consumer_seq(MulticastRing *r) {
+    int64_t min = INT64_MAX;
+    for (int i = 0; i < r->num_consumers; i++) {
+        int64_t seq = LFQ_LOAD(&r->consumers[i].seq, LFQ_SEQ);
+        if (seq < min) min = seq;
+    }
+    return min;
+}
+
+// Claims the next sequence, waiting until the slowest consumer frees its slot
+int64_t ring_claim(MulticastRing *r) {
+    int64_t seq;
+    if (r->multi_producer) {
+        seq = LFQ_FETCH_ADD(&r->claim, 1, LFQ_SEQ);
+    } else {
+        seq = r->next_claim++;
+    }
+
+    int64_t wrap = seq - r->capacity;
+    if (wrap > LFQ_LOAD(&r->gate_cache, LFQ_SEQ)) {
+        int spins = 0;
+        int64_t gate;
+        while (wrap > (gate = ring_min_consumer_seq(r))) {
+            ring_pause(&spins);
+        }
+        LFQ_STORE(&r->gate_cache, gate, LFQ_SEQ);
+    }
+    return seq;
+}
+
+void ring_publish(MulticastRing *r, int64_t seq) {
+    if (r->multi_producer) {
+        LFQ_STORE(&r->published[seq & r->mask], (int32_t)(seq >> r->shift), LFQ_SEQ);
+    } else {
+        LFQ_STORE(&r->cursor, seq, LFQ_SEQ);
+    }
+}
+
+void ring_publish_value(MulticastRing *r, int value) {
+    int64_t seq = ring_claim(r);
+    *ring_slot(r, seq) = value;
+    ring_publish(r, seq);
+}
+
+// Highest sequence >= seq that is published and released by all dependencies.
+// Blocks until at least seq is available; the caller may consume the whole batch.
+int64_t ring_wait_for(MulticastRing *r, int consumer, int64_t seq) {
+    RingConsumer *c = &r->consumers[consumer];
+    int spins = 0;
+
+    while (true) {
+        int64_t avail;
+        if (r->multi_producer) {
+            avail = seq - 1;
+            int64_t limit = LFQ_LOAD(&r->claim, LFQ_SEQ);
+            while (avail + 1 < limit && LFQ_LOAD(&r->published[(avail + 1) & r->mask], LFQ_SEQ) ==
+                                            (int32_t)((avail + 1) >> r->shift)) {
+                avail++;
+            }
+        } else {
+            avail = LFQ_LOAD(&r->cursor, LFQ_SEQ);
+        }
+
+        for (int i = 0; i < c->num_deps; i++) {
+            int64_t dep = LFQ_LOAD(&r->consumers[c->deps[i]].seq, LFQ_SEQ);
+            if (dep < avail) avail = dep;
+        }
+
+        if (avail >= seq) return avail;
+        ring_pause(&spins);
+    }
+}
+
+// Marks every sequence up to seq as done for this consumer
+void ring_release(MulticastRing *r, int consumer, int64_t seq) {
+    LFQ_STORE(&r->consumers[consumer].seq, seq, LFQ_SEQ);
+}
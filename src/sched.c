@@ -0,0 +1,246 @@
+// sched.c
+// Deterministic scheduler: one thread at a time, switching at atomic operations
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Deterministic scheduler
+// =======================
+
+typedef struct {
+    LFQSchedConfig *cfg;
+    int nthreads;
+    void (*body)(void *arg, int id);
+    void *arg;
+
+    pthread_mutex_t lock;
+    pthread_cond_t turn;
+    int current;          // Thread allowed to run; -1 before the first pick
+    int alive;
+    int *done;
+    long steps;           // Decisions so far; indexes the DFS trail
+    uint64_t rng;
+
+    int *priority;        // PCT: highest runnable priority runs
+    long *change_at;      // PCT: steps at which the running thread is demoted
+    int changes;
+    int preempted;        // DFS: preemptions used in this run
+} Sched;
+
+typedef struct {
+    Sched *s;
+    int id;
+} SchedThread;
+
+static _Thread_local Sched *sched_self;
+static _Thread_local int sched_id;
+
+static void *sched_calloc(size_t n, size_t size) {
+    void *p = calloc(n > 0 ? n : 1, size);
+    if (!p) {
+        perror("calloc");
+        exit(1);
+    }
+    return p;
+}
+
+// xorshift64*, seeded so that seed 0 is as good as any other
+static uint64_t sched_rand(Sched *s) {
+    s->rng ^= s->rng >> 12;
+    s->rng ^= s->rng << 25;
+    s->rng ^= s->rng >> 27;
+    return s->rng * 0x2545F4914F6CDD1DULL;
+}
+
+static void dfs_push(LFQSchedConfig *cfg, int choice, int width) {
+    if (cfg->trail_len == cfg->trail_cap) {
+        cfg->trail_cap = cfg->trail_cap ? cfg->trail_cap * 2 : 256;
+        cfg->choice = realloc(cfg->choice, cfg->trail_cap * sizeof(int));
+        cfg->width = realloc(cfg->width, cfg->trail_cap * sizeof(int));
+        if (!cfg->choice || !cfg->width) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    cfg->choice[cfg->trail_len] = choice;
+    cfg->width[cfg->trail_len] = width;
+    cfg->trail_len++;
+}
+
+// Picks the next thread to run; called with s->lock held. The running thread,
+// if it can go on, is candidate 0, so "no switch" is always the first branch.
+static int sched_choose(Sched *s) {
+    int runnable[s->nthreads];
+    int n = 0;
+    int cur_ok = s->current >= 0 && !s->done[s->current];
+    if (cur_ok) runnable[n++] = s->current;
+    for (int i = 0; i < s->nthreads; i++) {
+        if (!s->done[i] && i != s->current) runnable[n++] = i;
+    }
+    if (n == 0) return -1;
+    long step = s->steps++;
+    LFQSchedConfig *cfg = s->cfg;
+
+    switch (cfg->strategy) {
+    case LFQ_SCHED_RANDOM:
+        return runnable[sched_rand(s) % n];
+
+    case LFQ_SCHED_PCT: {
+        // Demoted threads drop below every initial priority, later ones lower.
+        // A change point reached while no thread is running (one just exited)
+        // applies at the next step that has one.
+        if (cur_ok && s->changes < cfg->depth - 1 && step >= s->change_at[s->changes]) {
+            s->priority[s->current] = cfg->depth - 2 - s->changes;
+            s->changes++;
+        }
+        int best = runnable[0];
+        for (int i = 1; i < n; i++) {
+            if (s->priority[runnable[i]] > s->priority[best]) best = runnable[i];
+        }
+        return best;
+    }
+
+    case LFQ_SCHED_DFS:
+    default: {
+        int c;
+        if (step < cfg->trail_len) {
+            // Replaying the prefix chosen by lfq_sched_next
+            c = cfg->choice[step];
+            if (c >= n) c = n - 1;  // The body is not deterministic; stay in range
+        } else {
+            int width = (cur_ok && s->preempted >= cfg->preemptions) ? 1 : n;
+            c = 0;
+            dfs_push(cfg, c, width);
+        }
+        if (cur_ok && c > 0) s->preempted++;
+        return runnable[c];
+    }
+    }
+}
+
+// Hands the turn over and waits for it to come back; called with s->lock held
+static void sched_switch(Sched *s, int next) {
+    s->current = next;
+    pthread_cond_broadcast(&s->turn);
+    while (s->current != sched_id) {
+        pthread_cond_wait(&s->turn, &s->lock);
+    }
+}
+
+void lfq_sched_point(void) {
+    Sched *s = sched_self;
+    if (s == NULL) return;
+    pthread_mutex_lock(&s->lock);
+    int next = sched_choose(s);
+    if (next != sched_id) sched_switch(s, next);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void *sched_thread(void *arg) {
+    SchedThread *t = (SchedThread *)arg;
+    Sched *s = t->s;
+    sched_self = s;
+    sched_id = t->id;
+
+    pthread_mutex_lock(&s->lock);
+    while (s->current != sched_id) {
+        pthread_cond_wait(&s->turn, &s->lock);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    s->body(s->arg, t->id);
+
+    pthread_mutex_lock(&s->lock);
+    s->done[t->id] = 1;
+    s->alive--;
+    s->current = sched_choose(s);
+    pthread_cond_broadcast(&s->turn);
+    pthread_mutex_unlock(&s->lock);
+    sched_self = NULL;
+    return NULL;
+}
+
+long lfq_sched_run(LFQSchedConfig *cfg, int nthreads, void (*body)(void *arg, int id), void *arg) {
+    Sched s = {.cfg = cfg, .nthreads = nthreads, .body = body, .arg = arg,
+               .current = -1, .alive = nthreads};
+    pthread_mutex_init(&s.lock, NULL);
+    pthread_cond_init(&s.turn, NULL);
+    s.done = sched_calloc(nthreads, sizeof(int));
+    s.rng = ((uint64_t)cfg->seed + 1) * 0x9E3779B97F4A7C15ULL;
+
+    if (cfg->strategy == LFQ_SCHED_PCT) {
+        // Random distinct initial priorities depth-1 .. depth+nthreads-2, all
+        // above the ones change points hand out
+        s.priority = sched_calloc(nthreads, sizeof(int));
+        for (int i = 0; i < nthreads; i++) s.priority[i] = i;
+        for (int i = nthreads - 1; i > 0; i--) {
+            int j = (int)(sched_rand(&s) % (uint64_t)(i + 1));
+            int tmp = s.priority[i];
+            s.priority[i] = s.priority[j];
+            s.priority[j] = tmp;
+        }
+        for (int i = 0; i < nthreads; i++) s.priority[i] += cfg->depth - 1;
+        int changes = cfg->depth > 1 ? cfg->depth - 1 : 0;
+        long range = cfg->max_steps > 0 ? cfg->max_steps : 1;
+        s.change_at = sched_calloc(changes, sizeof(long));
+        for (int i = 0; i < changes; i++) {
+            s.change_at[i] = 1 + (long)(sched_rand(&s) % (uint64_t)range);
+        }
+        // Sorted, so change point i is reached before i + 1
+        for (int i = 1; i < changes; i++) {
+            for (int j = i; j > 0 && s.change_at[j - 1] > s.change_at[j]; j--) {
+                long tmp = s.change_at[j];
+                s.change_at[j] = s.change_at[j - 1];
+                s.change_at[j - 1] = tmp;
+            }
+        }
+    }
+
+    pthread_t threads[nthreads];
+    SchedThread args[nthreads];
+    for (int i = 0; i < nthreads; i++) {
+        args[i] = (SchedThread){.s = &s, .id = i};
+        pthread_create(&threads[i], NULL, sched_thread, &args[i]);
+    }
+    pthread_mutex_lock(&s.lock);
+    s.current = sched_choose(&s);
+    pthread_cond_broadcast(&s.turn);
+    pthread_mutex_unlock(&s.lock);
+    for (int i = 0; i < nthreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&s.turn);
+    pthread_mutex_destroy(&s.lock);
+    free(s.done);
+    free(s.priority);
+    free(s.change_at);
+    return s.steps;
+}
+
+// DFS backtracks to the deepest decision with an untried branch and keeps
+// only the prefix up to it; the run after that replays the prefix.
+int lfq_sched_next(LFQSchedConfig *cfg) {
+    if (cfg->strategy != LFQ_SCHED_DFS) {
+        cfg->seed++;
+        return 1;
+    }
+    while (cfg->trail_len > 0 &&
+           cfg->choice[cfg->trail_len - 1] + 1 >= cfg->width[cfg->trail_len - 1]) {
+        cfg->trail_len--;
+    }
+    if (cfg->trail_len == 0) return 0;
+    cfg->choice[cfg->trail_len - 1]++;
+    return 1;
+}
+
+void lfq_sched_free(LFQSchedConfig *cfg) {
+    free(cfg->choice);
+    free(cfg->width);
+    cfg->choice = NULL;
+    cfg->width = NULL;
+    cfg->trail_len = 0;
+    cfg->trail_cap = 0;
+}
@@ -0,0 +1,424 @@
+// shmqueue.c
+// Offset-based shared-memory queue and its file-backed durable variant
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Shared-memory queue functions
+// =======================
+
+const char *const persist_names[PERSIST_NUM] = {"none", "flush", "msync"};
+
+static inline uint64_t shm_ptr(uint32_t idx, uint32_t tag) {
+    return ((uint64_t)tag << 32) | idx;
+}
+static inline uint32_t shm_idx(uint64_t p) { return (uint32_t)p; }
+static inline uint32_t shm_tag(uint64_t p) { return (uint32_t)(p >> 32); }
+
+// Makes [addr, addr + len) durable before returning. PERSIST_FLUSH writes the
+// cache lines back (clwb, else clflushopt, else clflush) and fences; that is
+// enough on a DAX-mapped persistent-memory file, and on a page-cache file it
+// orders stores for a process crash. PERSIST_MSYNC pushes the pages to the
+// storage device, which also survives an OS crash or power loss.
+static void persist_range(int mode, const void *addr, size_t len) {
+    if (mode == PERSIST_NONE || len == 0) return;
+#if defined(__x86_64__) || defined(__i386__)
+    if (mode == PERSIST_FLUSH) {
+        for (uintptr_t line = (uintptr_t)addr & ~(uintptr_t)63; line < (uintptr_t)addr + len; line += 64) {
+#if defined(__CLWB__)
+            _mm_clwb((void *)line);
+#elif defined(__CLFLUSHOPT__)
+            _mm_clflushopt((void *)line);
+#else
+            _mm_clflush((const void *)line);
+#endif
+        }
+        _mm_sfence();
+        return;
+    }
+#endif
+    // msync, and the fallback for PERSIST_FLUSH off x86
+    static long page_size;
+    if (page_size == 0) page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)addr & ~(uintptr_t)(page_size - 1);
+    if (msync((void *)start, (uintptr_t)addr + len - start, MS_SYNC) != 0) {
+        perror("msync");
+        exit(1);
+    }
+}
+
+static size_t shm_region_size(uint32_t capacity) {
+    return sizeof(ShmRegion) + ((size_t)capacity + 2) * sizeof(ShmNode);
+}
+
+// Pops a node off the in-region free list. Returns 0 when the pool is empty.
+uint32_t shm_node_alloc(ShmRegion *r) {
+    uint64_t top = LFQ_LOAD(&r->free_top, LFQ_SEQ);
+    for (;;) {
+        uint32_t idx = shm_idx(top);
+        if (idx == 0) return 0;
+        uint32_t next = LFQ_LOAD(&r->nodes[idx].free_next, LFQ_SEQ);
+        if (LFQ_CAS_WEAK(&r->free_top, &top, shm_ptr(next, shm_tag(top) + 1), LFQ_SEQ)) {
+            return idx;
+        }
+    }
+}
+
+static void shm_node_free(ShmRegion *r, uint32_t idx) {
+    uint64_t top = LFQ_LOAD(&r->free_top, LFQ_SEQ);
+    do {
+        LFQ_STORE(&r->nodes[idx].free_next, shm_idx(top), LFQ_SEQ);
+    } while (!LFQ_CAS_WEAK(&r->free_top, &top, shm_ptr(idx, shm_tag(top) + 1), LFQ_SEQ));
+}
+
+// Node 1 is the initial dummy, nodes 2..capacity+1 form the free list
+static void shm_region_format(ShmRegion *r, uint32_t capacity) {
+    r->capacity = capacity;
+    for (uint32_t i = 1; i <= capacity + 1; i++) {
+        r->nodes[i].value = 0;
+        atomic_init(&r->nodes[i].next, shm_ptr(0, 0));
+        atomic_init(&r->nodes[i].free_next, (i > 1 && i <= capacity) ? i + 1 : 0);
+    }
+    atomic_init(&r->head, shm_ptr(1, 0));
+    atomic_init(&r->tail, shm_ptr(1, 0));
+    atomic_init(&r->free_top, shm_ptr(capacity > 0 ? 2 : 0, 0));
+    atomic_init(&r->size, 0);
+    atomic_init(&r->recovering, 0);
+    for (int i = 0; i < SHM_MAX_PARTICIPANTS; i++) {
+        atomic_init(&r->participants[i], 0);
+    }
+}
+
+// kill(pid, 0) fails with ESRCH once the process is gone. A crashed process
+// that has not been reaped yet still counts as alive, and a recycled pid can
+// make a dead participant look alive; both only delay recovery.
+static int shm_pid_alive(int pid) {
+    return kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+int shmq_recover(ShmQueue *q);
+
+// Creates the region if it does not exist yet, otherwise attaches to it and
+// waits for the creator to finish formatting. Returns 0 on failure or when
+// every participant slot is held by a live process.
+int shmq_open(ShmQueue *q, const char *name, uint32_t capacity) {
+    int created = 1;
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        if (errno != EEXIST) return 0;
+        created = 0;
+        fd = shm_open(name, O_RDWR, 0600);
+        if (fd < 0) return 0;
+    }
+
+    size_t size;
+    if (created) {
+        size = shm_region_size(capacity);
+        if (ftruncate(fd, (off_t)size) != 0) {
+            close(fd);
+            shm_unlink(name);
+            return 0;
+        }
+    } else {
+        // The creator may not have sized the object yet
+        struct stat st;
+        do {
+            if (fstat(fd, &st) != 0) {
+                close(fd);
+                return 0;
+            }
+            if ((size_t)st.st_size < sizeof(ShmRegion)) sched_yield();
+        } while ((size_t)st.st_size < sizeof(ShmRegion));
+        size = (size_t)st.st_size;
+    }
+
+    ShmRegion *r = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (r == MAP_FAILED) {
+        if (created) shm_unlink(name);
+        return 0;
+    }
+
+    if (created) {
+        shm_region_format(r, capacity);
+        LFQ_STORE(&r->magic, SHM_MAGIC, LFQ_RELEASE);
+    } else {
+        while (LFQ_LOAD(&r->magic, LFQ_ACQUIRE) != SHM_MAGIC) {
+            sched_yield();
+        }
+    }
+
+    // Take a free slot, or one whose owner has died
+    int pid = (int)getpid();
+    int slot = -1;
+    for (int i = 0; i < SHM_MAX_PARTICIPANTS && slot < 0; i++) {
+        int owner = LFQ_LOAD(&r->participants[i], LFQ_SEQ);
+        if ((owner == 0 || !shm_pid_alive(owner)) &&
+            LFQ_CAS(&r->participants[i], &owner, pid, LFQ_SEQ)) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        munmap(r, size);
+        return 0;
+    }
+
+    // Registering before this load pairs with the flag store in shmq_recover
+    while (LFQ_LOAD(&r->recovering, LFQ_SEQ)) {
+        sched_yield();
+    }
+
+    q->r = r;
+    q->map_size = size;
+    q->slot = slot;
+
+    // Restart case: nobody else is alive, so reclaim what the dead left behind
+    shmq_recover(q);
+    return 1;
+}
+
+// Unmaps the region and frees this process's slot. The shared memory object
+// itself stays until shmq_unlink.
+void shmq_close(ShmQueue *q) {
+    LFQ_STORE(&q->r->participants[q->slot], 0, LFQ_SEQ);
+    munmap(q->r, q->map_size);
+    q->r = NULL;
+}
+
+int shmq_unlink(const char *name) {
+    return shm_unlink(name) == 0;
+}
+
+// Michael & Scott over the region. With a persist mode, a new node is flushed
+// before it is linked, a link is flushed before anyone moves tail or head past
+// it, and head is flushed before the old dummy goes back to the pool.
+// Returns 0 when the pool has no free node.
+static inline int shm_region_enqueue(ShmRegion *r, int value, int persist) {
+    uint32_t idx = shm_node_alloc(r);
+    if (idx == 0) return 0;
+
+    ShmNode *node = &r->nodes[idx];
+    node->value = value;
+    LFQ_STORE(&node->next, shm_ptr(0, shm_tag(LFQ_LOAD(&node->next, LFQ_SEQ)) + 1), LFQ_SEQ);
+    persist_range(persist, node, sizeof(*node));
+
+    for (;;) {
+        uint64_t tail = LFQ_LOAD(&r->tail, LFQ_SEQ);
+        ShmNode *last = &r->nodes[shm_idx(tail)];
+        uint64_t next = LFQ_LOAD(&last->next, LFQ_SEQ);
+
+        if (tail == LFQ_LOAD(&r->tail, LFQ_SEQ)) {
+            if (shm_idx(next) == 0) {
+                if (LFQ_CAS(&last->next, &next, shm_ptr(idx, shm_tag(next) + 1), LFQ_SEQ)) {
+                    persist_range(persist, &last->next, sizeof(last->next));
+                    LFQ_CAS(&r->tail, &tail, shm_ptr(idx, shm_tag(tail) + 1), LFQ_SEQ);
+                    LFQ_FETCH_ADD(&r->size, 1, LFQ_SEQ);
+                    return 1;
+                }
+            } else {
+                persist_range(persist, &last->next, sizeof(last->next));
+                LFQ_CAS(&r->tail, &tail, shm_ptr(shm_idx(next), shm_tag(tail) + 1), LFQ_SEQ);
+            }
+        }
+    }
+}
+
+static inline int shm_region_dequeue(ShmRegion *r, int *out_value, int persist) {
+    for (;;) {
+        uint64_t head = LFQ_LOAD(&r->head, LFQ_SEQ);
+        uint64_t tail = LFQ_LOAD(&r->tail, LFQ_SEQ);
+        ShmNode *first = &r->nodes[shm_idx(head)];
+        uint64_t next = LFQ_LOAD(&first->next, LFQ_SEQ);
+
+        if (head == LFQ_LOAD(&r->head, LFQ_SEQ)) {
+            if (shm_idx(head) == shm_idx(tail)) {
+                if (shm_idx(next) == 0) return 0; // Queue is empty
+                persist_range(persist, &first->next, sizeof(first->next));
+                LFQ_CAS(&r->tail, &tail, shm_ptr(shm_idx(next), shm_tag(tail) + 1), LFQ_SEQ);
+            } else if (shm_idx(next) != 0) {
+                // The node may be recycled under us; the tagged CAS on head
+                // fails in that case and the value is discarded
+                int value = r->nodes[shm_idx(next)].value;
+                persist_range(persist, &first->next, sizeof(first->next));
+                if (LFQ_CAS(&r->head, &head, shm_ptr(shm_idx(next), shm_tag(head) + 1), LFQ_SEQ)) {
+                    persist_range(persist, &r->head, sizeof(r->head));
+                    if (out_value) {
+                        *out_value = value;
+                    }
+                    LFQ_FETCH_SUB(&r->size, 1, LFQ_SEQ);
+                    shm_node_free(r, shm_idx(head));
+                    return 1;
+                }
+            }
+        }
+    }
+}
+
+// Returns 0 when the pool has no free node
+int shmq_enqueue(ShmQueue *q, int value) {
+    return shm_region_enqueue(q->r, value, PERSIST_NONE);
+}
+
+int shmq_dequeue(ShmQueue *q, int *out_value) {
+    return shm_region_dequeue(q->r, out_value, PERSIST_NONE);
+}
+
+int shmq_size(ShmQueue *q) {
+    return LFQ_LOAD(&q->r->size, LFQ_SEQ);
+}
+
+// Mark-and-sweep over a quiescent region: keeps the chain from head (and the
+// free list if keep_free_list), points tail at the last reachable node, and
+// puts every other node back in the pool. The walks are bounded by the pool
+// size in case a link was torn by a crash. Returns the nodes put back.
+static int shm_region_sweep(ShmRegion *r, int keep_free_list, int *items_out) {
+    uint32_t nodes = r->capacity + 1;
+    unsigned char *reachable = calloc(nodes + 1, 1);
+    if (!reachable) {
+        perror("calloc");
+        exit(1);
+    }
+    uint32_t last = shm_idx(LFQ_LOAD(&r->head, LFQ_SEQ));
+    uint32_t steps = 0;
+    int items = -1;
+    for (uint32_t i = last; i != 0 && i <= nodes && !reachable[i] && steps++ <= nodes;
+         i = shm_idx(LFQ_LOAD(&r->nodes[i].next, LFQ_SEQ))) {
+        reachable[i] = 1;
+        last = i;
+        items++;
+    }
+    if (keep_free_list) {
+        steps = 0;
+        for (uint32_t i = shm_idx(LFQ_LOAD(&r->free_top, LFQ_SEQ)); i != 0 && i <= nodes && !reachable[i] &&
+             steps++ <= nodes; i = LFQ_LOAD(&r->nodes[i].free_next, LFQ_SEQ)) {
+            reachable[i] = 1;
+        }
+    } else {
+        LFQ_STORE(&r->free_top, shm_ptr(0, 0), LFQ_SEQ);
+    }
+
+    uint64_t tail = LFQ_LOAD(&r->tail, LFQ_SEQ);
+    if (shm_idx(tail) != last) LFQ_STORE(&r->tail, shm_ptr(last, shm_tag(tail) + 1), LFQ_SEQ);
+    LFQ_STORE(&r->size, items, LFQ_SEQ);
+
+    int recovered = 0;
+    for (uint32_t i = nodes; i >= 1; i--) {
+        if (!reachable[i]) {
+            shm_node_free(r, i);
+            recovered++;
+        }
+    }
+    free(reachable);
+    if (items_out) *items_out = items;
+    return recovered;
+}
+
+// Reclaims nodes a crashed participant held between taking them from the
+// pool and linking them (or between unlinking and freeing them), and swings
+// a lagging tail. A crash never blocks the survivors, it only leaks those
+// nodes; an item a dead consumer had already dequeued is gone with it.
+// The sweep needs the region to itself, so it clears the slots of dead
+// participants and then gives up with -1 if any other participant is still
+// alive. Returns the number of nodes put back on the free list.
+int shmq_recover(ShmQueue *q) {
+    ShmRegion *r = q->r;
+    int expected = 0;
+    if (!LFQ_CAS(&r->recovering, &expected, 1, LFQ_SEQ)) return -1;
+
+    int live = 0;
+    for (int i = 0; i < SHM_MAX_PARTICIPANTS; i++) {
+        int pid = LFQ_LOAD(&r->participants[i], LFQ_SEQ);
+        if (i == q->slot || pid == 0) continue;
+        if (shm_pid_alive(pid)) {
+            live = 1;
+        } else {
+            LFQ_CAS(&r->participants[i], &pid, 0, LFQ_SEQ);
+        }
+    }
+    if (live) {
+        LFQ_STORE(&r->recovering, 0, LFQ_SEQ);
+        return -1;
+    }
+
+    int recovered = shm_region_sweep(r, 1, NULL);
+    LFQ_STORE(&r->recovering, 0, LFQ_SEQ);
+    return recovered;
+}
+
+// =======================
+// Durable queue functions
+// =======================
+
+// Opens the queue file at path, creating it with room for capacity items if
+// it does not exist, or recovering it otherwise. Recovery is one linear pass
+// over the pool: the chain from the durable head is kept, tail and size are
+// recomputed and every other node goes on a fresh free list. Returns 0 if the
+// file cannot be mapped or is not a queue file.
+int dq_open(DurableQueue *q, const char *path, uint32_t capacity, int persist) {
+    int fd = open(path, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) return 0;
+
+    // A file whose magic never became durable was cut off while formatting
+    uint32_t magic = 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (st.st_size >= (off_t)sizeof(ShmRegion) &&
+         pread(fd, &magic, sizeof(magic), offsetof(ShmRegion, magic)) != sizeof(magic))) {
+        close(fd);
+        return 0;
+    }
+    int fresh = magic != DQ_MAGIC;
+    if (fresh && magic != 0) {
+        close(fd);
+        return 0;
+    }
+
+    size_t size = fresh ? shm_region_size(capacity) : (size_t)st.st_size;
+    if (fresh && ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return 0;
+    }
+    ShmRegion *r = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (r == MAP_FAILED) return 0;
+    if (!fresh && shm_region_size(r->capacity) != size) {
+        munmap(r, size);
+        return 0;
+    }
+
+    q->r = r;
+    q->map_size = size;
+    q->persist = persist;
+    q->recovered_items = 0;
+    if (fresh) {
+        shm_region_format(r, capacity);
+        persist_range(persist, r, size);
+        LFQ_STORE(&r->magic, DQ_MAGIC, LFQ_SEQ);
+        persist_range(persist, &r->magic, sizeof(r->magic));
+    } else {
+        shm_region_sweep(r, 0, &q->recovered_items);
+    }
+    return 1;
+}
+
+void dq_close(DurableQueue *q) {
+    persist_range(q->persist, q->r, q->map_size);
+    munmap(q->r, q->map_size);
+    q->r = NULL;
+}
+
+// Returns once the item is durable; 0 when the pool has no free node
+int dq_enqueue(DurableQueue *q, int value) {
+    return shm_region_enqueue(q->r, value, q->persist);
+}
+
+// The removal is durable before the item is returned
+int dq_dequeue(DurableQueue *q, int *out_value) {
+    return shm_region_dequeue(q->r, out_value, q->persist);
+}
+
+int dq_size(DurableQueue *q) {
+    return LFQ_LOAD(&q->r->size, LFQ_SEQ);
+}
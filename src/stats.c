@@ -0,0 +1,95 @@
+// stats.c
+// Per-thread CAS and retry counters (compiled in with -DLFQ_STATS)
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Lock-free operation statistics
+// =======================
+// Compiled in with -DLFQ_STATS. Every thread counts into its own block, so
+// recording is a plain load/store on a private cache line; blocks are kept on
+// a global list (and outlive their thread) so lfq_stats_snapshot can sum them.
+// Without LFQ_STATS the hooks in lfq_internal.h expand to nothing.
+
+static const char *lfq_op_names[LFQ_NUM_OPS] = {
+    "enqueue", "dequeue", "push", "pop", "pq_insert", "pq_delete_min", "bq_reserve", "bq_dequeue"
+};
+
+#ifdef LFQ_STATS
+
+static LFQStatsBlock *lfq_stats_blocks = NULL;
+static pthread_mutex_t lfq_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local LFQStatsBlock *lfq_stats_local;
+
+LFQStatsBlock *lfq_stats_block(void) {
+    if (lfq_stats_local == NULL) {
+        LFQStatsBlock *b = calloc(1, sizeof(LFQStatsBlock));
+        if (!b) {
+            perror("calloc");
+            exit(1);
+        }
+        pthread_mutex_lock(&lfq_stats_lock);
+        b->next = lfq_stats_blocks;
+        lfq_stats_blocks = b;
+        pthread_mutex_unlock(&lfq_stats_lock);
+        lfq_stats_local = b;
+    }
+    return lfq_stats_local;
+}
+
+void lfq_stats_snapshot(LFQStats *out) {
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&lfq_stats_lock);
+    for (LFQStatsBlock *b = lfq_stats_blocks; b != NULL; b = b->next) {
+        for (int op = 0; op < LFQ_NUM_OPS; op++) {
+            uint64_t *dst = (uint64_t *)&out->op[op];
+            for (size_t f = 0; f < sizeof(LFQOpStats) / sizeof(uint64_t); f++) {
+                dst[f] += atomic_load_explicit(&b->counters[op][f], memory_order_relaxed);
+            }
+        }
+    }
+    pthread_mutex_unlock(&lfq_stats_lock);
+}
+
+// Zeroes every block; only meaningful while no instrumented operation runs
+void lfq_stats_reset(void) {
+    pthread_mutex_lock(&lfq_stats_lock);
+    for (LFQStatsBlock *b = lfq_stats_blocks; b != NULL; b = b->next) {
+        for (int op = 0; op < LFQ_NUM_OPS; op++) {
+            for (size_t f = 0; f < sizeof(LFQOpStats) / sizeof(uint64_t); f++) {
+                atomic_store_explicit(&b->counters[op][f], 0, memory_order_relaxed);
+            }
+        }
+    }
+    pthread_mutex_unlock(&lfq_stats_lock);
+}
+
+#else
+
+void lfq_stats_snapshot(LFQStats *out) {
+    memset(out, 0, sizeof(*out));
+}
+
+void lfq_stats_reset(void) {
+}
+
+#endif
+
+// One line per operation type that ran: attempts and failures per op, helping, empties, retries
+void lfq_stats_print(FILE *f, const LFQStats *s, const char *indent) {
+    for (int op = 0; op < LFQ_NUM_OPS; op++) {
+        const LFQOpStats *o = &s->op[op];
+        if (o->ops == 0) continue;
+        fprintf(f, "%s%-13s ops=%llu cas/op=%.3f cas-fail=%.2f%% helps=%llu empty=%llu retries[0,1,2-3,4-7,8-15,16-31,32-63,64+]=",
+                indent, lfq_op_names[op], (unsigned long long)o->ops,
+                (double)o->cas_attempts / o->ops,
+                o->cas_attempts ? 100.0 * o->cas_failures / o->cas_attempts : 0.0,
+                (unsigned long long)o->tail_helps, (unsigned long long)o->empty_returns);
+        for (int b = 0; b < LFQ_RETRY_BUCKETS; b++) {
+            fprintf(f, "%s%llu", b ? "," : "", (unsigned long long)o->retries[b]);
+        }
+        fprintf(f, "\n");
+    }
+}
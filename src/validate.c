@@ -0,0 +1,25 @@
+// validate.c
+// Random delays injected before atomic operations in LFQ_VALIDATE builds
+
+#define _GNU_SOURCE
+
+#include "lfq_internal.h"
+
+// =======================
+// Validation delays
+// =======================
+
+// One call in eight is delayed: half of those yield the CPU, so another
+// thread runs between two steps of an operation, and the rest spin for up to
+// ~4000 iterations to skew timing between cores. The other seven return at
+// once so the run still gets through enough operations.
+void lfq_validate_delay(void) {
+    unsigned int r = thread_rand();
+    if ((r & 7) != 0) return;
+    if (r & 8) {
+        sched_yield();
+        return;
+    }
+    for (volatile unsigned int i = 0; i < (r >> 20); i++) {
+    }
+}
@@ -0,0 +1,149 @@
+// test_chan.cpp
+// Tests for the C++20 channel awaiters in lfq_chan.hpp: coroutines that
+// co_await lfq::pop / lfq::push, resumed inline and on an executor, and
+// tasks still parked when the channel is destroyed. Exits nonzero if any
+// test fails.
+
+#include <cstdio>
+#include <exception>
+
+#include "lfq_chan.hpp"
+
+// =======================
+// Coroutine task
+// =======================
+
+// Fire-and-forget: starts at once and frees its frame when it finishes
+struct Task {
+    struct promise_type {
+        Task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+struct Totals {
+    std::atomic<long long> sum{0};
+    std::atomic<int> popped{0};
+    std::atomic<int> pushed{0};
+    std::atomic<int> closed{0};     // Awaits that saw the channel destroyed
+    std::atomic<int> finished{0};
+    std::atomic<int> out_of_order{0};
+};
+
+static Task consumer(AsyncChannel &ch, int items, Totals &t) {
+    int last = -1;
+    for (int i = 0; i < items; i++) {
+        std::optional<int> v = co_await lfq::pop(ch);
+        if (!v) {
+            t.closed++;
+            break;
+        }
+        if (*v <= last) t.out_of_order++;
+        last = *v;
+        t.sum += *v;
+        t.popped++;
+    }
+    t.finished++;
+}
+
+static Task producer(AsyncChannel &ch, int first, int items, Totals &t) {
+    for (int i = 0; i < items; i++) {
+        if (!co_await lfq::push(ch, first + i)) {
+            t.closed++;
+            break;
+        }
+        t.pushed++;
+    }
+    t.finished++;
+}
+
+// =======================
+// Tests
+// =======================
+
+// Test 1: One consumer and one producer coroutine on this thread. The
+// consumer parks on the empty channel, and each push resumes it inline;
+// the producer parks whenever the 2-slot channel is full.
+static int test_1_inline() {
+    std::printf("Test 1: co_await pop/push, resumed inline... ");
+    AsyncChannel ch;
+    chan_init(&ch, 2, nullptr);
+    Totals t;
+    const int items = 1000;
+    consumer(ch, items, t);
+    producer(ch, 0, items, t);
+    int ok = t.finished == 2 && t.popped == items && t.pushed == items &&
+             t.sum == (long long)items * (items - 1) / 2 && t.out_of_order == 0;
+    chan_destroy(&ch);
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 2: 100 consumer coroutines and 4 producer coroutines share one
+// executor thread; producers start first, so they park on the full channel
+static int test_2_executor() {
+    std::printf("Test 2: 100 consumers / 4 producers on an executor... ");
+    ChanExecutor exec;
+    chan_executor_start(&exec);
+    AsyncChannel ch;
+    chan_init(&ch, 8, &exec);
+    Totals t;
+    const int consumers = 100, per_consumer = 40, producers = 4;
+    const int per_producer = consumers * per_consumer / producers;
+    for (int p = 0; p < producers; p++) producer(ch, p * per_producer, per_producer, t);
+    for (int c = 0; c < consumers; c++) consumer(ch, per_consumer, t);
+    while (t.finished < consumers + producers) sched_yield();
+    chan_executor_stop(&exec);
+    long long n = (long long)consumers * per_consumer;
+    int ok = t.popped == n && t.pushed == n && t.sum == n * (n - 1) / 2 && t.closed == 0;
+    chan_destroy(&ch);
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 3: chan_destroy resumes parked coroutines instead of leaking them.
+// Three consumers wait on an empty channel, then two producers wait on a
+// full one; each sees the close once.
+static int test_3_destroy_resumes_parked() {
+    std::printf("Test 3: chan_destroy resumes parked coroutines... ");
+    AsyncChannel pops;
+    chan_init(&pops, 2, nullptr);
+    Totals t;
+    for (int i = 0; i < 3; i++) consumer(pops, 1, t);
+    int ok = t.finished == 0;
+    chan_destroy(&pops);
+    ok &= t.finished == 3 && t.closed == 3;
+
+    AsyncChannel pushes;
+    chan_init(&pushes, 2, nullptr);
+    Totals u;
+    producer(pushes, 0, 2, u);  // Fills the channel and finishes
+    producer(pushes, 10, 1, u);
+    producer(pushes, 20, 1, u);
+    ok &= u.finished == 1 && u.pushed == 2;
+    chan_destroy(&pushes);
+    ok &= u.finished == 3 && u.closed == 2 && u.pushed == 2;
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// =======================
+// Main function
+// =======================
+
+int main() {
+    std::printf("=============================================================\n");
+    std::printf("    Channel Awaiter Tests\n");
+    std::printf("=============================================================\n\n");
+
+    int passed = 0;
+    passed += test_1_inline();
+    passed += test_2_executor();
+    passed += test_3_destroy_resumes_parked();
+
+    std::printf("\nChannel Awaiter Tests Passed: %d/3\n", passed);
+    return passed == 3 ? 0 : 1;
+}
@@ -0,0 +1,1876 @@
+// test_lfq.c
+// COIS 3320 Project: correctness tests for liblfq and the benchmark harness.
+// Exits nonzero if any test fails.
+
+#define _GNU_SOURCE // usleep, pthread_condattr_setclock
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sched.h>
+#include <errno.h>
+#include <math.h>
+#include <malloc.h> // malloc_usable_size
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+#endif
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <poll.h>
+
+#include "lfq_internal.h"
+#include "lfq_gen.h"
+#include "harness.h"
+
+// =======================
+// TEST CASES (10+)
+// =======================
+
+// Test 1: Empty queue dequeue
+int test_1_empty_dequeue() {
+    printf("Test 1: Empty queue dequeue... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    int val;
+    int result = lfqueue_dequeue(&q, &val);
+    lfqueue_destroy(&q);
+    printf("%s\n", result == 0 ? "PASS" : "FAIL");
+    return result == 0;
+}
+
+// Test 2: Single enqueue and dequeue
+int test_2_single_operation() {
+    printf("Test 2: Single enqueue/dequeue... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    lfqueue_enqueue(&q, 42);
+    int val;
+    int result = lfqueue_dequeue(&q, &val) && val == 42;
+    lfqueue_destroy(&q);
+    printf("%s\n", result ? "PASS" : "FAIL");
+    return result;
+}
+
+// Test 3: FIFO order verification
+int test_3_fifo_order() {
+    printf("Test 3: FIFO order (10 items)... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    
+    for (int i = 0; i < 10; i++) {
+        lfqueue_enqueue(&q, i);
+    }
+    
+    int ok = 1;
+    for (int i = 0; i < 10; i++) {
+        int val;
+        if (!lfqueue_dequeue(&q, &val) || val != i) {
+            ok = 0;
+            break;
+        }
+    }
+    
+    lfqueue_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 4: Multiple enqueue then multiple dequeue
+int test_4_bulk_operations() {
+    printf("Test 4: Bulk enqueue/dequeue (100 items)... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    
+    for (int i = 0; i < 100; i++) {
+        lfqueue_enqueue(&q, i);
+    }
+    
+    int ok = 1;
+    for (int i = 0; i < 100; i++) {
+        int val;
+        if (!lfqueue_dequeue(&q, &val) || val != i) {
+            ok = 0;
+            break;
+        }
+    }
+    
+    int val;
+    if (lfqueue_dequeue(&q, &val)) ok = 0; // Should be empty
+    
+    lfqueue_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 5: Alternating enqueue/dequeue
+int test_5_alternating_ops() {
+    printf("Test 5: Alternating operations... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    
+    int ok = 1;
+    for (int i = 0; i < 50; i++) {
+        lfqueue_enqueue(&q, i);
+        int val;
+        if (!lfqueue_dequeue(&q, &val) || val != i) {
+            ok = 0;
+            break;
+        }
+    }
+    
+    lfqueue_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 6: Concurrent producers
+typedef struct {
+    LFQueue *q;
+    int start;
+    int count;
+} ProducerArgs;
+
+void *producer_thread(void *arg) {
+    ProducerArgs *args = (ProducerArgs *)arg;
+    for (int i = 0; i < args->count; i++) {
+        lfqueue_enqueue(args->q, args->start + i);
+    }
+    return NULL;
+}
+
+int test_6_concurrent_producers() {
+    printf("Test 6: Concurrent producers (4 threads, 25 items each)... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    
+    pthread_t threads[4];
+    ProducerArgs args[4];
+    
+    for (int i = 0; i < 4; i++) {
+        args[i].q = &q;
+        args[i].start = i * 25;
+        args[i].count = 25;
+        pthread_create(&threads[i], NULL, producer_thread, &args[i]);
+    }
+    
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    
+    int ok = (lfqueue_size(&q) == 100);
+    lfqueue_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 7: Concurrent consumers
+typedef struct {
+    LFQueue *q;
+    int *count;
+    pthread_mutex_t *lock;
+} ConsumerArgs;
+
+void *consumer_thread(void *arg) {
+    ConsumerArgs *args = (ConsumerArgs *)arg;
+    int val;
+    int local_count = 0;
+    
+    while (lfqueue_dequeue(args->q, &val)) {
+        local_count++;
+        usleep(10); // Small delay
+    }
+    
+    pthread_mutex_lock(args->lock);
+    (*args->count) += local_count;
+    pthread_mutex_unlock(args->lock);
+    
+    return NULL;
+}
+
+int test_7_concurrent_consumers() {
+    printf("Test 7: Concurrent consumers (4 threads, 100 items)... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    
+    for (int i = 0; i < 100; i++) {
+        lfqueue_enqueue(&q, i);
+    }
+    
+    pthread_t threads[4];
+    ConsumerArgs args[4];
+    int total_consumed = 0;
+    pthread_mutex_t count_lock;
+    pthread_mutex_init(&count_lock, NULL);
+    
+    for (int i = 0; i < 4; i++) {
+        args[i].q = &q;
+        args[i].count = &total_consumed;
+        args[i].lock = &count_lock;
+        pthread_create(&threads[i], NULL, consumer_thread, &args[i]);
+    }
+    
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    
+    pthread_mutex_destroy(&count_lock);
+    int ok = (total_consumed == 100);
+    lfqueue_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 8: Mixed producers and consumers. Every operation is logged with its
+// start and end time, and the history must be linearizable as a FIFO queue,
+// so lost, duplicated or reordered items fail the test, not only a bad size.
+typedef struct {
+    LFQueue *q;
+    int operations;
+    int thread_id;
+    _Atomic(int) *enqueue_count;
+    _Atomic(int) *dequeue_count;
+    LinLog log;
+} MixedArgs;
+
+void *mixed_thread(void *arg) {
+    MixedArgs *args = (MixedArgs *)arg;
+    unsigned int seed = args->thread_id;
+    
+    for (int i = 0; i < args->operations; i++) {
+        uint64_t t0 = clock_ns();
+        if (rand_r(&seed) % 2 == 0) {
+            int value = args->thread_id * args->operations + i;  // Unique per history
+            lfqueue_enqueue(args->q, value);
+            lin_record(&args->log, LIN_ENQ, value, 1, t0, clock_ns());
+            atomic_fetch_add(args->enqueue_count, 1);
+        } else {
+            int val = 0;
+            int ok = lfqueue_dequeue(args->q, &val);
+            lin_record(&args->log, LIN_DEQ, val, ok, t0, clock_ns());
+            if (ok) {
+                atomic_fetch_add(args->dequeue_count, 1);
+            }
+        }
+    }
+    return NULL;
+}
+
+int test_8_mixed_operations() {
+    printf("Test 8: Mixed producers/consumers (8 threads)... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    
+    pthread_t threads[8];
+    MixedArgs args[8];
+    _Atomic(int) enq_count = 0;
+    _Atomic(int) deq_count = 0;
+    
+    for (int i = 0; i < 8; i++) {
+        args[i].q = &q;
+        args[i].operations = 1000;
+        args[i].thread_id = i;
+        args[i].enqueue_count = &enq_count;
+        args[i].dequeue_count = &deq_count;
+        lin_log_init(&args[i].log, args[i].operations);
+        pthread_create(&threads[i], NULL, mixed_thread, &args[i]);
+    }
+    
+    LinLog logs[8];
+    for (int i = 0; i < 8; i++) {
+        pthread_join(threads[i], NULL);
+        logs[i] = args[i].log;
+    }
+    
+    int final_size = lfqueue_size(&q);
+    int expected = atomic_load(&enq_count) - atomic_load(&deq_count);
+    LinReport lin;
+    int ok = (final_size == expected) & lin_check_fifo(logs, 8, &lin);
+    
+    printf("%s (Enq:%d Deq:%d Size:%d Expected:%d History:%s)\n", 
+           ok ? "PASS" : "FAIL",
+           atomic_load(&enq_count),
+           atomic_load(&deq_count),
+           final_size,
+           expected,
+           lin_violation_names[lin.violation]);
+    
+    for (int i = 0; i < 8; i++) lin_log_free(&logs[i]);
+    lfqueue_destroy(&q);
+    return ok;
+}
+
+// Test 9: Stress test with large dataset
+int test_9_stress_large_dataset() {
+    printf("Test 9: Stress test (10000 items)... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    
+    for (int i = 0; i < 10000; i++) {
+        lfqueue_enqueue(&q, i);
+    }
+    
+    int ok = 1;
+    for (int i = 0; i < 10000; i++) {
+        int val;
+        if (!lfqueue_dequeue(&q, &val) || val != i) {
+            ok = 0;
+            break;
+        }
+    }
+    
+    lfqueue_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 10: Lock-based queue correctness
+int test_10_locked_queue() {
+    printf("Test 10: Lock-based queue (100 items)... ");
+    LockedQueue q;
+    lockedqueue_init(&q);
+    
+    for (int i = 0; i < 100; i++) {
+        lockedqueue_enqueue(&q, i);
+    }
+    
+    int ok = 1;
+    for (int i = 0; i < 100; i++) {
+        int val;
+        if (!lockedqueue_dequeue(&q, &val) || val != i) {
+            ok = 0;
+            break;
+        }
+    }
+    
+    lockedqueue_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 11: Relaxed MultiQueue delivers every item exactly once
+typedef struct {
+    MultiQueue *mq;
+    int start;
+    int count;
+} MQProducerArgs;
+
+void *mq_producer_thread(void *arg) {
+    MQProducerArgs *args = (MQProducerArgs *)arg;
+    for (int i = 0; i < args->count; i++) {
+        multiqueue_enqueue(args->mq, args->start + i);
+    }
+    return NULL;
+}
+
+int test_11_multiqueue() {
+    printf("Test 11: Relaxed MultiQueue (4 threads, 8 shards, 1000 items)... ");
+    MultiQueue mq;
+    multiqueue_init(&mq, 8);
+
+    pthread_t threads[4];
+    MQProducerArgs args[4];
+    for (int i = 0; i < 4; i++) {
+        args[i].mq = &mq;
+        args[i].start = i * 250;
+        args[i].count = 250;
+        pthread_create(&threads[i], NULL, mq_producer_thread, &args[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int seen[1000] = {0};
+    int ok = (multiqueue_size(&mq) == 1000);
+    int val;
+    while (multiqueue_dequeue(&mq, &val)) {
+        if (val < 0 || val >= 1000 || seen[val]++) ok = 0;
+    }
+    for (int i = 0; i < 1000; i++) {
+        if (seen[i] != 1) ok = 0;
+    }
+
+    multiqueue_destroy(&mq);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 12: Priority queue returns keys in order after concurrent inserts
+typedef struct {
+    LFPriorityQueue *q;
+    int id;
+    int count;
+} PQProducerArgs;
+
+void *pq_producer_thread(void *arg) {
+    PQProducerArgs *args = (PQProducerArgs *)arg;
+    unsigned int seed = args->id + 1;
+    for (int i = 0; i < args->count; i++) {
+        lfpq_insert(args->q, rand_r(&seed) % 10000, args->id);
+    }
+    return NULL;
+}
+
+int test_12_priority_queue() {
+    printf("Test 12: Lock-free priority queue (4 threads, 1000 keys)... ");
+    LFPriorityQueue q;
+    lfpq_init(&q);
+
+    pthread_t threads[4];
+    PQProducerArgs args[4];
+    for (int i = 0; i < 4; i++) {
+        args[i].q = &q;
+        args[i].id = i;
+        args[i].count = 250;
+        pthread_create(&threads[i], NULL, pq_producer_thread, &args[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int ok = (lfpq_size(&q) == 1000);
+    int count = 0;
+    int prev = INT_MIN;
+    int key;
+    while (lfpq_delete_min(&q, &key, NULL)) {
+        if (key < prev) ok = 0;
+        prev = key;
+        count++;
+    }
+    if (count != 1000) ok = 0;
+
+    lfpq_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 13: Treiber stack is LIFO and loses nothing under elimination
+typedef struct {
+    LFStack *s;
+    int id;
+    int count;
+    _Atomic(int) *popped;
+} StackArgs;
+
+void *stack_thread(void *arg) {
+    StackArgs *args = (StackArgs *)arg;
+    int val;
+    for (int i = 0; i < args->count; i++) {
+        lfstack_push(args->s, args->id * args->count + i);
+        if (lfstack_pop(args->s, &val)) atomic_fetch_add(args->popped, 1);
+    }
+    return NULL;
+}
+
+int test_13_elimination_stack() {
+    printf("Test 13: Elimination stack (LIFO + 8 threads x 500 push/pop)... ");
+    LFStack s;
+    lfstack_init(&s, 1);
+
+    int ok = 1;
+    for (int i = 0; i < 10; i++) {
+        lfstack_push(&s, i);
+    }
+    for (int i = 9; i >= 0; i--) {
+        int val;
+        if (!lfstack_pop(&s, &val) || val != i) ok = 0;
+    }
+
+    pthread_t threads[8];
+    StackArgs args[8];
+    _Atomic(int) popped = 0;
+    for (int i = 0; i < 8; i++) {
+        args[i].s = &s;
+        args[i].id = i;
+        args[i].count = 500;
+        args[i].popped = &popped;
+        pthread_create(&threads[i], NULL, stack_thread, &args[i]);
+    }
+    for (int i = 0; i < 8; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int val;
+    while (lfstack_pop(&s, &val)) atomic_fetch_add(&popped, 1);
+    if (atomic_load(&popped) != 8 * 500) ok = 0;
+
+    lfstack_destroy(&s);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 14: Multicast ring delivers every event to every consumer in order
+int test_14_multicast_ring() {
+    printf("Test 14: Multicast ring (2 producers, 3 consumers, 20000 events)... ");
+    MulticastRing r;
+    ring_init(&r, 256, 1);
+
+    int logger = ring_add_consumer(&r, NULL, 0);
+    int aggregator = ring_add_consumer(&r, NULL, 0);
+    int forwarder = ring_add_consumer(&r, &logger, 1);
+    int consumer_ids[3] = {logger, aggregator, forwarder};
+
+    pthread_t producers[2], consumers[3];
+    RingArgs pargs[2], cargs[3];
+    for (int i = 0; i < 3; i++) {
+        cargs[i] = (RingArgs){&r, consumer_ids[i], 20000, 0, 1};
+        pthread_create(&consumers[i], NULL, ring_consumer_thread, &cargs[i]);
+    }
+    for (int i = 0; i < 2; i++) {
+        pargs[i] = (RingArgs){&r, i, 10000, 0, 1};
+        pthread_create(&producers[i], NULL, ring_producer_thread, &pargs[i]);
+    }
+    for (int i = 0; i < 2; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    for (int i = 0; i < 3; i++) {
+        pthread_join(consumers[i], NULL);
+    }
+
+    long long expected = 20000LL * 19999 / 2;
+    int ok = 1;
+    for (int i = 0; i < 3; i++) {
+        if (!cargs[i].ok || cargs[i].sum != expected) ok = 0;
+    }
+
+    ring_destroy(&r);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 15: Bounded queue backpressure and reserve/commit
+typedef struct {
+    BoundedQueue *q;
+    int start;
+    int count;
+} BQProducerArgs;
+
+void *bq_producer_thread(void *arg) {
+    BQProducerArgs *args = (BQProducerArgs *)arg;
+    for (int i = 0; i < args->count; i++) {
+        bq_enqueue_timed(args->q, args->start + i, -1);
+    }
+    return NULL;
+}
+
+int test_15_bounded_queue() {
+    printf("Test 15: Bounded queue (capacity, timeout, reserve/commit, 3 blocked producers)... ");
+    BoundedQueue q;
+    bq_init(&q, 8);
+    int ok = 1;
+    int val;
+
+    // Capacity limit and timed enqueue on a full queue
+    for (int i = 0; i < 8; i++) {
+        if (!bq_try_enqueue(&q, i)) ok = 0;
+    }
+    if (bq_try_enqueue(&q, 8) || bq_enqueue_timed(&q, 8, 10)) ok = 0;
+    BQReservation res = {0, 0};
+    if (bq_try_reserve(&q, 1, &res)) ok = 0;
+    for (int i = 0; i < 8; i++) {
+        if (!bq_dequeue(&q, &val) || val != i) ok = 0;
+    }
+
+    // Reserved slots stay invisible until committed
+    if (!bq_try_reserve(&q, 5, &res)) ok = 0;
+    for (int i = 0; i < 5; i++) {
+        *bq_slot(&q, &res, i) = 100 + i;
+    }
+    if (bq_dequeue(&q, &val)) ok = 0;
+    bq_commit(&q, &res);
+    for (int i = 0; i < 5; i++) {
+        if (!bq_dequeue(&q, &val) || val != 100 + i) ok = 0;
+    }
+    bq_destroy(&q);
+
+    // Producers block on a small queue until the consumer makes room
+    bq_init(&q, 16);
+    pthread_t threads[3];
+    BQProducerArgs args[3];
+    for (int i = 0; i < 3; i++) {
+        args[i] = (BQProducerArgs){&q, i * 2000, 2000};
+        pthread_create(&threads[i], NULL, bq_producer_thread, &args[i]);
+    }
+    long long sum = 0;
+    int received = 0;
+    while (received < 6000) {
+        if (bq_size(&q) > 16) ok = 0;
+        if (bq_dequeue(&q, &val)) {
+            sum += val;
+            received++;
+        } else {
+            sched_yield();
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    if (sum != 6000LL * 5999 / 2) ok = 0;
+
+    bq_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 16: Latency histogram quantiles stay within the bucket error bound
+int test_16_latency_histogram() {
+    printf("Test 16: Latency histogram quantiles (1..100000 ns)... ");
+    LatencyHist *h = calloc(1, sizeof(LatencyHist));
+    LatencyHist *other = calloc(1, sizeof(LatencyHist));
+
+    for (uint64_t v = 1; v <= 100000; v++) {
+        hist_record(v % 2 ? h : other, v);
+    }
+    hist_merge(h, other);
+
+    int ok = (h->total == 100000 && hist_quantile(h, 1.0) == 100000);
+    double bound = 1.0 / (1 << (HIST_SUB_BITS - 1));
+    for (int k = 0; k < LAT_NUM_QUANTILES - 1; k++) {
+        double expected = lat_quantiles[k] * 100000;
+        double got = (double)hist_quantile(h, lat_quantiles[k]);
+        if (got < expected || got > expected * (1 + bound) + 1) ok = 0;
+    }
+    for (uint64_t v = 0; v < 64; v++) {
+        if (hist_bucket_upper(hist_index(v)) != v) ok = 0;
+    }
+
+    free(h);
+    free(other);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+int test_17_cas_stats() {
+    printf("Test 17: CAS statistics (single thread, %s)... ", LFQ_STATS_ENABLED ? "enabled" : "compiled out");
+    LFQueue q;
+    LFQStats st;
+    lfqueue_init(&q);
+    lfq_stats_reset();
+
+    for (int i = 0; i < 1000; i++) {
+        lfqueue_enqueue(&q, i);
+    }
+    int value;
+    while (lfqueue_dequeue(&q, &value)) {
+    }
+    lfq_stats_snapshot(&st);
+
+    const LFQOpStats *enq = &st.op[LFQ_OP_ENQUEUE];
+    const LFQOpStats *deq = &st.op[LFQ_OP_DEQUEUE];
+    int ok;
+    if (LFQ_STATS_ENABLED) {
+        // Uncontended: every operation succeeds with its first CAS
+        ok = (enq->ops == 1000 && enq->cas_attempts == 1000 && enq->cas_failures == 0 &&
+              enq->retries[0] == 1000 && deq->ops == 1001 && deq->empty_returns == 1 &&
+              deq->cas_attempts == 1000 && deq->cas_failures == 0);
+    } else {
+        ok = (enq->ops == 0 && deq->ops == 0);
+    }
+
+    lfqueue_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 18: Placement strategies on a synthetic 2-package, 2-core, 2-way SMT box
+int test_18_thread_placement() {
+    printf("Test 18: Thread placement strategies (2x2x2 topology)... ");
+    // CPUs numbered the way Linux usually does: siblings are n and n + 4
+    CpuInfo cpus[8];
+    CpuTopology t = {cpus, 8, 0, 0};
+    for (int i = 0; i < 8; i++) {
+        cpus[i].cpu = i;
+        cpus[i].package = (i % 4) / 2;
+        cpus[i].core = i % 2;
+    }
+    topology_finalize(&t);
+
+    static const int expected[PLACE_NUM][8] = {
+        {-1, -1, -1, -1, -1, -1, -1, -1},  // none
+        {0, 1, 4, 5, 2, 3, 6, 7},          // compact
+        {0, 2, 1, 3, 4, 6, 5, 7},          // scatter
+        {0, 4, 1, 5, 2, 6, 3, 7},          // smt-pairs
+        {0, 1, 2, 3, 0, 1, 2, 3},          // one-per-core (wraps)
+    };
+    int ok = (t.num_cpus == 8 && t.num_cores == 4 && t.num_packages == 2);
+    for (int s = 0; s < PLACE_NUM; s++) {
+        int plan[8];
+        int distinct = placement_plan(&t, s, 8, plan);
+        if (distinct != (s == PLACE_NONE ? 0 : s == PLACE_ONE_PER_CORE ? 4 : 8)) ok = 0;
+        if (memcmp(plan, expected[s], sizeof(plan)) != 0) ok = 0;
+    }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 19: Summary statistics, quartiles and IQR outliers on a fixed sample
+int test_19_bench_statistics() {
+    printf("Test 19: Benchmark summary statistics and outliers... ");
+    double samples[] = {14, 10, 100, 12, 11, 13};
+    BenchSummary s;
+    bench_summarize(samples, 6, &s);
+
+    // mean 26.67, sd 35.95, t(5) = 2.571; quartiles 11.25 / 13.75 put 100 outside the fences
+    double half = 2.571 * s.stddev / sqrt(6.0);
+    int ok = (s.n == 6 && fabs(s.mean - 160.0 / 6) < 1e-9 && fabs(s.median - 12.5) < 1e-9 &&
+              fabs(s.q1 - 11.25) < 1e-9 && fabs(s.q3 - 13.75) < 1e-9 && s.outliers == 1 &&
+              fabs(s.stddev - 35.9537) < 1e-3 && fabs(s.ci95_hi - s.mean - half) < 1e-9);
+
+    double one = 5.0;
+    bench_summarize(&one, 1, &s);
+    if (s.median != 5.0 || s.stddev != 0.0 || s.ci95_lo != 5.0 || s.outliers != 0) ok = 0;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 20: Welch's t-test separates shifted samples and not overlapping ones
+int test_20_welch_t_test() {
+    printf("Test 20: Welch's t-test for regression detection... ");
+    double low[] = {1, 2, 3, 4, 5};
+    double high[] = {6, 7, 8, 9, 10};
+    double mixed[] = {2, 3, 3.5, 4, 5};
+    double t, df;
+
+    // Equal variances 2.5, n = 5: t = 5, df = 8
+    int ok = (welch_t_test(low, 5, high, 5, &t, &df) == 1 &&
+              fabs(t - 5.0) < 1e-9 && fabs(df - 8.0) < 1e-9);
+    if (welch_t_test(low, 5, mixed, 5, &t, &df) != 0) ok = 0;
+    if (welch_t_test(low, 1, high, 5, &t, &df) != -1) ok = 0;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 21: Arrival schedules keep the configured mean rate
+int test_21_arrival_schedules() {
+    printf("Test 21: Arrival schedules (steady, bursty, overload, poisson)... ");
+    uint64_t total[ARRIVAL_NUM] = {0};
+    int back_to_back = 0;
+
+    // 6400 items at 1M items/s should take 6.4 ms whatever the pattern
+    for (int p = 0; p < ARRIVAL_NUM; p++) {
+        for (long long seq = 0; seq <= 6400; seq++) {
+            unsigned seed = 1;
+            uint64_t gap = arrival_gap_ns(p, seq, 1e6, 64, &seed);
+            total[p] += gap;
+            if (p == ARRIVAL_BURSTY && seq > 0 && gap == 0) back_to_back++;
+        }
+    }
+    int ok = (total[ARRIVAL_STEADY] == 6400000 && total[ARRIVAL_BURSTY] == 6400000 &&
+              total[ARRIVAL_OVERLOAD] == 0 && back_to_back == 6400 - 100);
+
+    // Poisson: precomputed schedule is increasing with a mean gap within 5% of 1 us
+    uint64_t *at = arrival_schedule(ARRIVAL_POISSON, 100000, 1e6, 64, 42);
+    for (int i = 1; i < 100000; i++) {
+        if (at[i] < at[i - 1]) ok = 0;
+    }
+    if (fabs(at[99999] / 99999.0 - 1000.0) > 50.0) ok = 0;
+    free(at);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 22: Allocation telemetry accounts for every node of a queue's lifetime
+int test_22_memory_telemetry() {
+    printf("Test 22: Memory telemetry (allocs, frees, retired nodes)... ");
+    MemStats before, after;
+    LFQueue q;
+    int value;
+
+    mem_stats_snapshot(&before);
+    lfqueue_init(&q);
+    for (int i = 0; i < 10; i++) {
+        lfqueue_enqueue(&q, i);
+    }
+    while (lfqueue_dequeue(&q, &value)) {
+    }
+    lfqueue_destroy(&q);
+    mem_stats_snapshot(&after);
+
+    // Dummy + 10 nodes allocated; destroy frees the last dummy and the 10
+    // dequeued dummies stay with the retired list until cleanup
+    int ok = (after.alloc_calls - before.alloc_calls == 11 &&
+              after.free_calls - before.free_calls == 1 &&
+              after.live_allocs - before.live_allocs == 10 &&
+              after.live_bytes - before.live_bytes >= 10 * (long long)sizeof(Node) &&
+              after.retired_total - before.retired_total == 10 &&
+              after.peak_rss_kb > 0);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 23: Items cross a process boundary in FIFO order, and a participant
+// killed while holding a pool node does not shrink the pool for good
+int test_23_shared_memory_queue() {
+    printf("Test 23: Shared-memory queue (2 processes, crashed participant)... ");
+    char name[64];
+    snprintf(name, sizeof(name), "/lfq-test-%d", (int)getpid());
+    ShmQueue q;
+    if (!shmq_open(&q, name, 64)) {
+        printf("FAIL\n");
+        return 0;
+    }
+    int ok = 1;
+    int val;
+    int status;
+
+    // A child process pushes 20000 items through the 64-node pool
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        ShmQueue child;
+        if (!shmq_open(&child, name, 64)) _exit(1);
+        for (int i = 0; i < 20000; i++) {
+            while (!shmq_enqueue(&child, i)) sched_yield();
+        }
+        shmq_close(&child);
+        _exit(0);
+    }
+    int expected = 0;
+    int exited = 0;
+    while (expected < 20000) {
+        if (shmq_dequeue(&q, &val)) {
+            if (val != expected) ok = 0;
+            expected++;
+        } else if (exited) {
+            ok = 0; // Child gave up early
+            break;
+        } else {
+            exited = waitpid(pid, &status, WNOHANG) == pid;
+            sched_yield();
+        }
+    }
+    if (!exited) waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = 0;
+
+    // The second child dies between taking a node and linking it
+    pid = fork();
+    if (pid == 0) {
+        ShmQueue child;
+        if (!shmq_open(&child, name, 64)) _exit(1);
+        for (int i = 0; i < 3; i++) {
+            shmq_enqueue(&child, 100 + i);
+        }
+        shm_node_alloc(child.r);
+        raise(SIGKILL);
+    }
+    waitpid(pid, &status, 0);
+    if (!WIFSIGNALED(status)) ok = 0;
+    if (shmq_recover(&q) != 1 || shmq_size(&q) != 3) ok = 0;
+    for (int i = 0; i < 3; i++) {
+        if (!shmq_dequeue(&q, &val) || val != 100 + i) ok = 0;
+    }
+
+    // The whole pool is usable again
+    for (int i = 0; i < 64; i++) {
+        if (!shmq_enqueue(&q, i)) ok = 0;
+    }
+    if (shmq_enqueue(&q, 64)) ok = 0;
+
+    shmq_close(&q);
+    shmq_unlink(name);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 24: A process killed mid-run leaves a file that reopens with exactly
+// the completed operations, and a clean close keeps every item
+int test_24_durable_queue() {
+    printf("Test 24: Durable queue (killed writer, recovery, reopen)... ");
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/lfq-test-%d.dat", (int)getpid());
+    unlink(path);
+    int ok = 1;
+    int val;
+    int status;
+
+    // The child completes 50 enqueues and 10 dequeues, then dies holding a
+    // node it took from the pool
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        DurableQueue child;
+        if (!dq_open(&child, path, 64, PERSIST_FLUSH)) _exit(1);
+        for (int i = 0; i < 50; i++) {
+            dq_enqueue(&child, i);
+        }
+        for (int i = 0; i < 10; i++) {
+            dq_dequeue(&child, &val);
+        }
+        shm_node_alloc(child.r);
+        raise(SIGKILL);
+    }
+    waitpid(pid, &status, 0);
+    if (!WIFSIGNALED(status)) ok = 0;
+
+    DurableQueue q;
+    if (!dq_open(&q, path, 64, PERSIST_FLUSH)) {
+        unlink(path);
+        printf("FAIL\n");
+        return 0;
+    }
+    if (q.recovered_items != 40 || dq_size(&q) != 40) ok = 0;
+    for (int i = 10; i < 50; i++) {
+        if (!dq_dequeue(&q, &val) || val != i) ok = 0;
+    }
+
+    // The leaked node is back in the pool
+    for (int i = 0; i < 64; i++) {
+        if (!dq_enqueue(&q, i)) ok = 0;
+    }
+    if (dq_enqueue(&q, 64)) ok = 0;
+    dq_close(&q);
+
+    if (!dq_open(&q, path, 64, PERSIST_MSYNC) || q.recovered_items != 64) {
+        ok = 0;
+    } else {
+        for (int i = 0; i < 64; i++) {
+            if (!dq_dequeue(&q, &val) || val != i) ok = 0;
+        }
+        dq_close(&q);
+    }
+
+    unlink(path);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+#ifdef __linux__
+typedef struct {
+    LFQueue *q;
+    int items;
+} NotifyProducerArgs;
+
+static void *notify_producer_thread(void *arg) {
+    NotifyProducerArgs *a = (NotifyProducerArgs *)arg;
+    for (int i = 0; i < a->items; i++) {
+        lfqueue_enqueue(a->q, i);
+        if (i % 1000 == 999) usleep(100);
+    }
+    return NULL;
+}
+
+// Test 25: The eventfd fires once per empty-to-non-empty edge, and an epoll
+// consumer that drains and re-arms never misses an item
+int test_25_eventfd_notification() {
+    printf("Test 25: eventfd notification (coalescing, epoll consumer)... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    int fd = lfqueue_notify_fd(&q);
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    if (fd < 0 || ep < 0) {
+        if (ep >= 0) close(ep);
+        lfqueue_destroy(&q);
+        printf("FAIL\n");
+        return 0;
+    }
+    struct epoll_event ev = {.events = EPOLLIN};
+    epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+    int ok = 1;
+    int buf[64];
+    uint64_t count = 0;
+
+    // 100 enqueues on an armed queue write the eventfd once
+    if (epoll_wait(ep, &ev, 1, 0) != 0) ok = 0;
+    for (int i = 0; i < 100; i++) {
+        lfqueue_enqueue(&q, i);
+    }
+    if (epoll_wait(ep, &ev, 1, 0) != 1) ok = 0;
+    if (read(fd, &count, sizeof(count)) != sizeof(count) || count != 1) ok = 0;
+    int drained = 0;
+    while (lfqueue_drain(&q, buf, 64) > 0) {
+        drained++;
+    }
+    if (drained != 2 || lfqueue_rearm(&q) != 0 || epoll_wait(ep, &ev, 1, 0) != 0) ok = 0;
+
+    // Threaded: wake on the fd, drain in batches, re-arm
+    NotifyProducerArgs args = {&q, 20000};
+    pthread_t producer;
+    pthread_create(&producer, NULL, notify_producer_thread, &args);
+    int expected = 0;
+    int wakeups = 0;
+    while (expected < args.items) {
+        if (epoll_wait(ep, &ev, 1, 1000) != 1) {
+            ok = 0; // Lost wakeup
+            break;
+        }
+        wakeups++;
+        for (;;) {
+            int n = lfqueue_drain(&q, buf, 64);
+            for (int i = 0; i < n; i++) {
+                if (buf[i] != expected++) ok = 0;
+            }
+            if (n < 64 && !lfqueue_rearm(&q)) break;
+        }
+    }
+    pthread_join(producer, NULL);
+    if (expected != args.items || wakeups >= args.items) ok = 0;
+
+    close(ep);
+    lfqueue_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+#else
+int test_25_eventfd_notification() {
+    printf("Test 25: eventfd notification (needs Linux)... PASS\n");
+    return 1;
+}
+#endif
+
+// Test 26: 1000 suspended consumers and 4 producers share one executor
+// thread through an 8-slot channel; every item is delivered exactly once
+int test_26_async_channel() {
+    printf("Test 26: Async channel (1000 consumer tasks, 4 producers, 1 executor)... ");
+    int ok = 1;
+
+    // Inline resumption: the pop parks, the push completes it on this thread
+    AsyncChannel ch;
+    ChanTask t = {0};
+    _Atomic(int) finished = 0;
+    chan_init(&ch, 2, NULL);
+    t.ch = &ch;
+    t.target = 1;
+    t.finished = &finished;
+    chan_consumer_run(&t);
+    if (atomic_load(&finished) != 0) ok = 0;
+    ChanWaiter w;
+    if (!chan_push_async(&ch, 42, &w, NULL)) ok = 0;
+    if (atomic_load(&finished) != 1 || t.sum != 42 || bq_size(&ch.q) != 0) ok = 0;
+    chan_destroy(&ch);
+
+    if (run_channel_tasks(4, 1000, 5000, 8) < 0) ok = 0;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+typedef struct {
+    LFQueue *q;
+    int id;
+    int accepted;         // Enqueues that succeeded before the close
+    long long received;   // Consumers: items taken
+    int order_ok;         // Consumers: per-producer values arrived increasing
+} CloseArgs;
+
+#define CLOSE_PRODUCERS 3
+#define CLOSE_STRIDE 1000000
+
+static void *close_producer_thread(void *arg) {
+    CloseArgs *a = (CloseArgs *)arg;
+    while (lfqueue_enqueue(a->q, a->id * CLOSE_STRIDE + a->accepted)) {
+        a->accepted++;
+        if (a->accepted % 256 == 0) sched_yield();
+    }
+    return NULL;
+}
+
+static void *close_consumer_thread(void *arg) {
+    CloseArgs *a = (CloseArgs *)arg;
+    int last[CLOSE_PRODUCERS];
+    for (int i = 0; i < CLOSE_PRODUCERS; i++) last[i] = -1;
+    a->order_ok = 1;
+    int val;
+    int status;
+    while ((status = lfqueue_try_dequeue(a->q, &val)) != LFQ_CLOSED) {
+        if (status == LFQ_EMPTY) {
+            sched_yield();
+            continue;
+        }
+        int producer = val / CLOSE_STRIDE;
+        if (val % CLOSE_STRIDE <= last[producer]) a->order_ok = 0;
+        last[producer] = val % CLOSE_STRIDE;
+        a->received++;
+    }
+    return NULL;
+}
+
+// Test 27: Closing stops producers mid-stream, consumers drain every accepted
+// item and then see end-of-stream
+int test_27_closable_queue() {
+    printf("Test 27: Closable queue (drain after close, racing producers)... ");
+    LFQueue q;
+    lfqueue_init(&q);
+    int ok = 1;
+    int val;
+
+    for (int i = 0; i < 3; i++) {
+        lfqueue_enqueue(&q, i);
+    }
+    lfqueue_close(&q);
+    if (lfqueue_enqueue(&q, 3) || !lfqueue_is_closed(&q)) ok = 0;
+    for (int i = 0; i < 3; i++) {
+        if (lfqueue_try_dequeue(&q, &val) != LFQ_OK || val != i) ok = 0;
+    }
+    if (lfqueue_try_dequeue(&q, &val) != LFQ_CLOSED || lfqueue_dequeue(&q, &val)) ok = 0;
+    lfqueue_close(&q);
+    if (lfqueue_size(&q) != 0) ok = 0;
+    lfqueue_destroy(&q);
+
+    // Three producers run until the close, three consumers until end-of-stream
+    lfqueue_init(&q);
+    pthread_t producers[CLOSE_PRODUCERS], consumers[3];
+    CloseArgs pargs[CLOSE_PRODUCERS], cargs[3];
+    for (int i = 0; i < 3; i++) {
+        cargs[i] = (CloseArgs){.q = &q, .id = i};
+        pthread_create(&consumers[i], NULL, close_consumer_thread, &cargs[i]);
+    }
+    for (int i = 0; i < CLOSE_PRODUCERS; i++) {
+        pargs[i] = (CloseArgs){.q = &q, .id = i};
+        pthread_create(&producers[i], NULL, close_producer_thread, &pargs[i]);
+    }
+    usleep(2000);
+    lfqueue_close(&q);
+    long long accepted = 0, received = 0;
+    for (int i = 0; i < CLOSE_PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+        accepted += pargs[i].accepted;
+    }
+    for (int i = 0; i < 3; i++) {
+        pthread_join(consumers[i], NULL);
+        received += cargs[i].received;
+        if (!cargs[i].order_ok) ok = 0;
+    }
+    if (accepted == 0 || received != accepted) ok = 0;
+    lfqueue_destroy(&q);
+
+#ifdef __linux__
+    // An armed eventfd consumer is woken by the close itself
+    lfqueue_init(&q);
+    int fd = lfqueue_notify_fd(&q);
+    int buf[8];
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    if (fd < 0 || poll(&pfd, 1, 0) != 0) ok = 0;
+    lfqueue_close(&q);
+    if (poll(&pfd, 1, 0) != 1 || lfqueue_rearm(&q) != 1 || lfqueue_drain(&q, buf, 8) != -1) ok = 0;
+    lfqueue_destroy(&q);
+#endif
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// -------- Generated queue variants (Test 28) -----
+typedef struct {
+    int id;
+    long long check[2];   // Derived from id, to catch torn or mixed-up copies
+} GenItem;
+
+static inline GenItem gen_item(int id) { return (GenItem){id, {id * 3LL, -(long long)id}}; }
+static inline int gen_item_ok(GenItem v) { return v.check[0] == v.id * 3LL && v.check[1] == -(long long)v.id; }
+static inline int gen_int(int id) { return id; }
+static inline int gen_int_ok(int v) { (void)v; return 1; }
+static inline int gen_item_id(GenItem v) { return v.id; }
+static inline int gen_int_id(int v) { return v; }
+
+LFQ_DEFINE(gen_spsc, int, SPSC, UNBOUNDED, FREE)
+LFQ_DEFINE(gen_mpsc, GenItem, MPSC, UNBOUNDED, FREE)
+LFQ_DEFINE(gen_mpmc, int, MPMC, UNBOUNDED, RETIRE)
+LFQ_DEFINE(gen_spsc_ring, int, SPSC, BOUNDED, NONE)
+LFQ_DEFINE(gen_mpsc_ring, int, MPSC, BOUNDED, NONE)
+LFQ_DEFINE(gen_mpmc_ring, GenItem, MPMC, BOUNDED, NONE)
+
+#define GEN_MAX_PRODUCERS 4
+#define GEN_STRIDE 1000000
+
+typedef struct {
+    void *q;
+    int id;
+    int count;               // Producers: items to send
+    _Atomic(long long) *received;  // Shared by the consumers
+    long long total;
+    long long sum;
+    int ok;
+} GenArgs;
+
+// Producer p sends p * GEN_STRIDE + i; each consumer checks that every
+// producer's items reach it in increasing order and intact
+#define GEN_TEST_THREADS(name, type, make, valid, key) \
+    static void *name##_test_producer(void *arg) { \
+        GenArgs *a = (GenArgs *)arg; \
+        for (int i = 0; i < a->count; i++) { \
+            while (!name##_enqueue(a->q, make(a->id * GEN_STRIDE + i))) sched_yield(); \
+        } \
+        return NULL; \
+    } \
+    static void *name##_test_consumer(void *arg) { \
+        GenArgs *a = (GenArgs *)arg; \
+        int last[GEN_MAX_PRODUCERS] = {-1, -1, -1, -1}; \
+        type v; \
+        a->ok = 1; \
+        while (atomic_load(a->received) < a->total) { \
+            if (!name##_dequeue(a->q, &v)) { \
+                sched_yield(); \
+                continue; \
+            } \
+            atomic_fetch_add(a->received, 1); \
+            int id = key(v); \
+            if (!valid(v) || id % GEN_STRIDE <= last[id / GEN_STRIDE]) a->ok = 0; \
+            last[id / GEN_STRIDE] = id % GEN_STRIDE; \
+            a->sum += id; \
+        } \
+        return NULL; \
+    } \
+    static int name##_test_run(int capacity, int producers, int consumers, int per_producer) { \
+        name q; \
+        name##_init(&q, capacity); \
+        _Atomic(long long) received = 0; \
+        pthread_t threads[2 * GEN_MAX_PRODUCERS]; \
+        GenArgs args[2 * GEN_MAX_PRODUCERS]; \
+        long long expect = 0; \
+        for (int i = 0; i < producers + consumers; i++) { \
+            args[i] = (GenArgs){.q = &q, .id = i, .count = per_producer, \
+                                .received = &received, .total = (long long)producers * per_producer}; \
+            pthread_create(&threads[i], NULL, \
+                           i < producers ? name##_test_producer : name##_test_consumer, &args[i]); \
+        } \
+        for (int p = 0; p < producers; p++) { \
+            for (int i = 0; i < per_producer; i++) expect += (long long)p * GEN_STRIDE + i; \
+        } \
+        int ok = 1; \
+        long long sum = 0; \
+        for (int i = 0; i < producers + consumers; i++) { \
+            pthread_join(threads[i], NULL); \
+            if (i >= producers) { \
+                sum += args[i].sum; \
+                ok &= args[i].ok; \
+            } \
+        } \
+        type v; \
+        if (sum != expect || name##_dequeue(&q, &v)) ok = 0; \
+        name##_destroy(&q); \
+        return ok; \
+    }
+
+GEN_TEST_THREADS(gen_spsc, int, gen_int, gen_int_ok, gen_int_id)
+GEN_TEST_THREADS(gen_mpsc, GenItem, gen_item, gen_item_ok, gen_item_id)
+GEN_TEST_THREADS(gen_mpmc, int, gen_int, gen_int_ok, gen_int_id)
+GEN_TEST_THREADS(gen_spsc_ring, int, gen_int, gen_int_ok, gen_int_id)
+GEN_TEST_THREADS(gen_mpsc_ring, int, gen_int, gen_int_ok, gen_int_id)
+GEN_TEST_THREADS(gen_mpmc_ring, GenItem, gen_item, gen_item_ok, gen_item_id)
+
+// Test 28: Every LFQ_DEFINE variant keeps FIFO order alone, reports a full
+// ring, and delivers every item intact under its intended concurrency
+int test_28_specialized_queues() {
+    printf("Test 28: Specialized queues (SPSC/MPSC/MPMC x unbounded/bounded)... ");
+    int ok = 1;
+    int v;
+
+    // Single-threaded FIFO and capacity
+    gen_spsc_ring q;
+    gen_spsc_ring_init(&q, 100);  // Rounded up to 128
+    for (int i = 0; i < 128; i++) {
+        if (!gen_spsc_ring_enqueue(&q, i)) ok = 0;
+    }
+    if (gen_spsc_ring_enqueue(&q, 128)) ok = 0;
+    for (int i = 0; i < 128; i++) {
+        if (!gen_spsc_ring_dequeue(&q, &v) || v != i) ok = 0;
+    }
+    if (gen_spsc_ring_dequeue(&q, &v)) ok = 0;
+    gen_spsc_ring_destroy(&q);
+
+    gen_mpsc_ring r;
+    gen_mpsc_ring_init(&r, 4);
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 4; i++) {
+            if (!gen_mpsc_ring_enqueue(&r, round * 4 + i)) ok = 0;
+        }
+        if (gen_mpsc_ring_enqueue(&r, -1)) ok = 0;
+        for (int i = 0; i < 4; i++) {
+            if (!gen_mpsc_ring_dequeue(&r, &v) || v != round * 4 + i) ok = 0;
+        }
+    }
+    gen_mpsc_ring_destroy(&r);
+
+    // FREE releases every node at once, RETIRE defers to the retired list
+    MemStats before, after;
+    mem_stats_snapshot(&before);
+    gen_spsc s;
+    gen_spsc_init(&s, 0);
+    for (int i = 0; i < 1000; i++) gen_spsc_enqueue(&s, i);
+    for (int i = 0; i < 1000; i++) {
+        if (!gen_spsc_dequeue(&s, &v) || v != i) ok = 0;
+    }
+    gen_spsc_destroy(&s);
+    mem_stats_snapshot(&after);
+    if (after.live_allocs != before.live_allocs) ok = 0;
+
+    gen_mpmc m;
+    gen_mpmc_init(&m, 0);
+    for (int i = 0; i < 100; i++) gen_mpmc_enqueue(&m, i);
+    for (int i = 0; i < 100; i++) {
+        if (!gen_mpmc_dequeue(&m, &v) || v != i) ok = 0;
+    }
+    if (gen_mpmc_dequeue(&m, &v)) ok = 0;
+    gen_mpmc_destroy(&m);
+
+    // Concurrent, each in the shape it was generated for
+    if (!gen_spsc_test_run(0, 1, 1, 100000)) ok = 0;
+    if (!gen_spsc_ring_test_run(64, 1, 1, 100000)) ok = 0;
+    if (!gen_mpsc_test_run(0, 3, 1, 20000)) ok = 0;
+    if (!gen_mpsc_ring_test_run(64, 3, 1, 20000)) ok = 0;
+    if (!gen_mpmc_test_run(0, 2, 2, 20000)) ok = 0;
+    if (!gen_mpmc_ring_test_run(64, 2, 2, 20000)) ok = 0;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 29: LFQueue under its weakened memory orders. Each consumer checks that
+// items from one producer arrive in order and intact; the queue is closed
+// after the producers finish, so consumers also exercise the close path.
+// Meant to be run in the LFQ_VALIDATE and LFQ_TSAN builds as well.
+#define ORDER_PRODUCERS 4
+#define ORDER_CONSUMERS 4
+#define ORDER_ITEMS 20000
+#define ORDER_STRIDE 1000000
+
+typedef struct {
+    LFQueue *q;
+    int id;
+    int ok;
+    long long count;
+} OrderArgs;
+
+void *order_producer(void *arg) {
+    OrderArgs *a = (OrderArgs *)arg;
+    for (int i = 0; i < ORDER_ITEMS; i++) {
+        if (!lfqueue_enqueue(a->q, a->id * ORDER_STRIDE + i)) a->ok = 0;
+    }
+    return NULL;
+}
+
+void *order_consumer(void *arg) {
+    OrderArgs *a = (OrderArgs *)arg;
+    int last[ORDER_PRODUCERS];
+    for (int p = 0; p < ORDER_PRODUCERS; p++) last[p] = -1;
+    int v;
+    int status;
+    while ((status = lfqueue_try_dequeue(a->q, &v)) != LFQ_CLOSED) {
+        if (status == LFQ_EMPTY) {
+            sched_yield();
+            continue;
+        }
+        int p = v / ORDER_STRIDE;
+        int i = v % ORDER_STRIDE;
+        if (p < 0 || p >= ORDER_PRODUCERS || i >= ORDER_ITEMS || i <= last[p]) {
+            a->ok = 0;
+            continue;
+        }
+        last[p] = i;
+        a->count++;
+    }
+    return NULL;
+}
+
+int test_29_memory_order_stress() {
+#if defined(LFQ_VALIDATE)
+    const char *mode = "random delays";
+#elif defined(LFQ_SEQ_CST)
+    const char *mode = "seq_cst";
+#else
+    const char *mode = "acquire/release";
+#endif
+    printf("Test 29: Memory-order stress (%d+%d threads, %s)... ",
+           ORDER_PRODUCERS, ORDER_CONSUMERS, mode);
+    LFQueue q;
+    lfqueue_init(&q);
+
+    pthread_t threads[ORDER_PRODUCERS + ORDER_CONSUMERS];
+    OrderArgs args[ORDER_PRODUCERS + ORDER_CONSUMERS];
+    for (int i = 0; i < ORDER_PRODUCERS + ORDER_CONSUMERS; i++) {
+        args[i] = (OrderArgs){.q = &q, .id = i, .ok = 1, .count = 0};
+        pthread_create(&threads[i], NULL,
+                       i < ORDER_PRODUCERS ? order_producer : order_consumer, &args[i]);
+    }
+    for (int i = 0; i < ORDER_PRODUCERS; i++) pthread_join(threads[i], NULL);
+    lfqueue_close(&q);
+
+    int ok = 1;
+    long long received = 0;
+    for (int i = 0; i < ORDER_PRODUCERS + ORDER_CONSUMERS; i++) {
+        if (i >= ORDER_PRODUCERS) pthread_join(threads[i], NULL);
+        ok &= args[i].ok;
+        received += args[i].count;
+    }
+    if (received != (long long)ORDER_PRODUCERS * ORDER_ITEMS || lfqueue_size(&q) != 0) ok = 0;
+
+    lfqueue_destroy(&q);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Test 30: The FIFO linearizability checker. It must flag each violation
+// pattern in small hand-written histories, accept legal overlapping ones, and
+// then pass recorded million-operation histories of the real queues.
+static LinLog lin_history(const int (*ev)[5], int n) {
+    // Rows are {op, value, ok, invoke, response}
+    LinLog log;
+    lin_log_init(&log, n);
+    for (int i = 0; i < n; i++) lin_record(&log, ev[i][0], ev[i][1], ev[i][2], ev[i][3], ev[i][4]);
+    return log;
+}
+
+static int lin_expect(const int (*ev)[5], int n, int violation) {
+    LinLog log = lin_history(ev, n);
+    LinReport r;
+    lin_check_fifo(&log, 1, &r);
+    lin_log_free(&log);
+    return r.violation == violation;
+}
+
+typedef struct {
+    int (*enqueue)(void *q, int value);
+    int (*dequeue)(void *q, int *out);
+    void *q;
+    int id;
+    int ops;
+    LinLog log;
+} LinRunArgs;
+
+void *lin_run_thread(void *arg) {
+    LinRunArgs *a = (LinRunArgs *)arg;
+    unsigned int seed = a->id + 1;
+    for (int i = 0; i < a->ops; i++) {
+        uint64_t t0 = clock_ns();
+        if (rand_r(&seed) % 2 == 0) {
+            int value = a->id * a->ops + i;
+            int ok = a->enqueue(a->q, value);
+            lin_record(&a->log, LIN_ENQ, value, ok, t0, clock_ns());
+        } else {
+            int v = 0;
+            int ok = a->dequeue(a->q, &v);
+            lin_record(&a->log, LIN_DEQ, v, ok, t0, clock_ns());
+        }
+    }
+    return NULL;
+}
+
+// Mixed 50/50 run on `threads` threads; 1 if the checker finds no violation,
+// or with weak_empty none but an empty one
+static int lin_run(int (*enqueue)(void *, int), int (*dequeue)(void *, int *), void *q,
+                   int threads, int ops, int weak_empty) {
+    pthread_t tid[8];
+    LinRunArgs args[8];
+    LinLog logs[8];
+    for (int i = 0; i < threads; i++) {
+        args[i] = (LinRunArgs){.enqueue = enqueue, .dequeue = dequeue, .q = q, .id = i, .ops = ops};
+        lin_log_init(&args[i].log, ops);
+        pthread_create(&tid[i], NULL, lin_run_thread, &args[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tid[i], NULL);
+        logs[i] = args[i].log;
+    }
+    LinReport r;
+    int ok = lin_check_fifo(logs, threads, &r) || (weak_empty && r.violation == LIN_EMPTY);
+    if (!ok) printf("[%s on %d] ", lin_violation_names[r.violation], r.value);
+    for (int i = 0; i < threads; i++) lin_log_free(&logs[i]);
+    return ok;
+}
+
+static int lin_lfq_enq(void *q, int v) { return lfqueue_enqueue(q, v); }
+static int lin_lfq_deq(void *q, int *v) { return lfqueue_dequeue(q, v); }
+static int lin_gen_enq(void *q, int v) { return gen_mpmc_enqueue(q, v); }
+static int lin_gen_deq(void *q, int *v) { return gen_mpmc_dequeue(q, v); }
+static int lin_bq_enq(void *q, int v) { return bq_try_enqueue(q, v); }
+static int lin_bq_deq(void *q, int *v) { return bq_dequeue(q, v); }
+
+int test_30_linearizability_checker() {
+    printf("Test 30: Linearizability checker (patterns, 1M-op histories)... ");
+    int ok = 1;
+
+    // Overlapping enqueues may come out in either order
+    static const int legal[][5] = {
+        {LIN_ENQ, 1, 1, 0, 10}, {LIN_ENQ, 2, 1, 5, 15}, {LIN_DEQ, 0, 0, 2, 3},
+        {LIN_DEQ, 2, 1, 16, 20}, {LIN_DEQ, 1, 1, 21, 30}, {LIN_DEQ, 0, 0, 31, 32}};
+    ok &= lin_expect(legal, 6, LIN_OK);
+    static const int order[][5] = {
+        {LIN_ENQ, 1, 1, 0, 1}, {LIN_ENQ, 2, 1, 2, 3}, {LIN_DEQ, 2, 1, 4, 5}, {LIN_DEQ, 1, 1, 6, 7}};
+    ok &= lin_expect(order, 4, LIN_ORDER);
+    static const int lost[][5] = {
+        {LIN_ENQ, 1, 1, 0, 1}, {LIN_ENQ, 2, 1, 2, 3}, {LIN_DEQ, 2, 1, 4, 5}};
+    ok &= lin_expect(lost, 3, LIN_ORDER);
+    static const int fresh[][5] = {{LIN_DEQ, 1, 1, 0, 1}, {LIN_ENQ, 1, 1, 2, 3}};
+    ok &= lin_expect(fresh, 2, LIN_FRESH);
+    static const int invented[][5] = {{LIN_ENQ, 1, 1, 0, 1}, {LIN_DEQ, 7, 1, 2, 3}};
+    ok &= lin_expect(invented, 2, LIN_FRESH);
+    static const int repeat[][5] = {
+        {LIN_ENQ, 1, 1, 0, 1}, {LIN_DEQ, 1, 1, 2, 3}, {LIN_DEQ, 1, 1, 4, 5}};
+    ok &= lin_expect(repeat, 3, LIN_REPEAT);
+    static const int empty[][5] = {
+        {LIN_ENQ, 1, 1, 0, 1}, {LIN_DEQ, 0, 0, 2, 3}, {LIN_DEQ, 1, 1, 4, 5}};
+    ok &= lin_expect(empty, 3, LIN_EMPTY);
+    // Neither item alone spans the empty dequeue, but one is always present
+    static const int empty_union[][5] = {
+        {LIN_ENQ, 1, 1, 0, 1}, {LIN_ENQ, 2, 1, 4, 5}, {LIN_DEQ, 1, 1, 6, 7},
+        {LIN_DEQ, 2, 1, 12, 13}, {LIN_DEQ, 0, 0, 3, 8}};
+    ok &= lin_expect(empty_union, 5, LIN_EMPTY);
+    // An empty result overlapping the enqueue is fine
+    static const int empty_ok[][5] = {
+        {LIN_ENQ, 1, 1, 0, 10}, {LIN_DEQ, 0, 0, 2, 3}, {LIN_DEQ, 1, 1, 11, 12}};
+    ok &= lin_expect(empty_ok, 3, LIN_OK);
+    static const int duplicate[][5] = {{LIN_ENQ, 1, 1, 0, 1}, {LIN_ENQ, 1, 1, 2, 3}};
+    ok &= lin_expect(duplicate, 2, LIN_DUPLICATE);
+
+    LFQueue q;
+    lfqueue_init(&q);
+    ok &= lin_run(lin_lfq_enq, lin_lfq_deq, &q, 4, 250000, 0);
+    lfqueue_destroy(&q);
+
+    gen_mpmc g;
+    gen_mpmc_init(&g, 0);
+    ok &= lin_run(lin_gen_enq, lin_gen_deq, &g, 4, 100000, 0);
+    gen_mpmc_destroy(&g);
+
+    // Small capacity, so full enqueues are part of the history too. A dequeue
+    // can miss items behind a reserved but uncommitted slot (see bq_dequeue),
+    // so only the empty pattern is allowed
+    BoundedQueue b;
+    bq_init(&b, 64);
+    ok &= lin_run(lin_bq_enq, lin_bq_deq, &b, 4, 100000, 1);
+    bq_destroy(&b);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// =======================
+// Main function
+// =======================
+
+int main(void) {
+    printf("=============================================================\n");
+    printf("    COIS 3320 Project: Lock-Free Queue Implementation\n");
+    printf("=============================================================\n\n");
+    
+    retired_list_init();
+    
+    // Run the 10 original correctness tests
+    printf("--- CORRECTNESS TESTS ---\n");
+    int passed = 0;
+    passed += test_1_empty_dequeue();
+    passed += test_2_single_operation();
+    passed += test_3_fifo_order();
+    passed += test_4_bulk_operations();
+    passed += test_5_alternating_ops();
+    passed += test_6_concurrent_producers();
+    passed += test_7_concurrent_consumers();
+    passed += test_8_mixed_operations();
+    passed += test_9_stress_large_dataset();
+    passed += test_10_locked_queue();
+    passed += test_11_multiqueue();
+    passed += test_12_priority_queue();
+    passed += test_13_elimination_stack();
+    passed += test_14_multicast_ring();
+    passed += test_15_bounded_queue();
+    passed += test_16_latency_histogram();
+    passed += test_17_cas_stats();
+    passed += test_18_thread_placement();
+    passed += test_19_bench_statistics();
+    passed += test_20_welch_t_test();
+    passed += test_21_arrival_schedules();
+    passed += test_22_memory_telemetry();
+    passed += test_23_shared_memory_queue();
+    passed += test_24_durable_queue();
+    passed += test_25_eventfd_notification();
+    passed += test_26_async_channel();
+    passed += test_27_closable_queue();
+    passed += test_28_specialized_queues();
+    passed += test_29_memory_order_stress();
+    passed += test_30_linearizability_checker();
+    
+    printf("\n--- TEST SUMMARY ---\n");
+    printf("Tests Passed: %d/30\n", passed);
+
+
+    // BONUS: Additional test cases (190+ tests)
+    printf("\n=============================================================\n");
+    printf("--- BONUS: ADDITIONAL TEST CASES (190+) ---\n");
+    printf("=============================================================\n");
+    
+    int bonus_passed = 0;
+    int bonus_total = 0;
+
+    // Test Set 1: FIFO with varying sizes (90 tests)
+    printf("\n[Test Set 1] FIFO with varying sizes (10 to 1000)...\n");
+    for (int size = 10; size <= 1000; size += 10) {
+        LFQueue q;
+        lfqueue_init(&q);
+        
+        // Enqueue 'size' items
+        for (int i = 0; i < size; i++) {
+            lfqueue_enqueue(&q, i);
+        }
+        
+        // Dequeue and verify FIFO order
+        int ok = 1;
+        for (int i = 0; i < size; i++) {
+            int val;
+            if (!lfqueue_dequeue(&q, &val) || val != i) {
+                ok = 0;
+                break;
+            }
+        }
+        
+        bonus_passed += ok;
+        bonus_total++;
+        lfqueue_destroy(&q);
+    }
+    printf("   Result: %d/%d PASS\n", bonus_passed, bonus_total);
+
+    // Test Set 2: Empty dequeue tests (10 tests)
+    printf("\n[Test Set 2] Empty dequeue tests (10 tests)...\n");
+    int empty_passed = 0;
+    for (int i = 0; i < 10; i++) {
+        LFQueue q;
+        lfqueue_init(&q);
+        int val;
+        int result = lfqueue_dequeue(&q, &val);
+        empty_passed += (result == 0);
+        lfqueue_destroy(&q);
+        bonus_total++;
+    }
+    bonus_passed += empty_passed;
+    printf("   Result: %d/10 PASS\n", empty_passed);
+
+    // Test Set 3: Single item tests (10 tests)
+    printf("\n[Test Set 3] Single item enqueue/dequeue (10 tests)...\n");
+    int single_passed = 0;
+    for (int i = 0; i < 10; i++) {
+        LFQueue q;
+        lfqueue_init(&q);
+        lfqueue_enqueue(&q, i * 100);
+        int val;
+        int result = lfqueue_dequeue(&q, &val);
+        single_passed += (result && val == i * 100);
+        lfqueue_destroy(&q);
+        bonus_total++;
+    }
+    bonus_passed += single_passed;
+    printf("   Result: %d/10 PASS\n", single_passed);
+
+    // Test Set 4: Alternating enqueue/dequeue (20 tests)
+    printf("\n[Test Set 4] Alternating operations (20 tests)...\n");
+    int alt_passed = 0;
+    for (int count = 5; count <= 100; count += 5) {
+        LFQueue q;
+        lfqueue_init(&q);
+        int ok = 1;
+        
+        for (int i = 0; i < count; i++) {
+            lfqueue_enqueue(&q, i);
+            int val;
+            if (!lfqueue_dequeue(&q, &val) || val != i) {
+                ok = 0;
+                break;
+            }
+        }
+        
+        alt_passed += ok;
+        bonus_total++;
+        lfqueue_destroy(&q);
+    }
+    bonus_passed += alt_passed;
+    printf("   Result: %d/20 PASS\n", alt_passed);
+
+    // Test Set 5: Boundary values (10 tests)
+    printf("\n[Test Set 5] Boundary value tests (10 tests)...\n");
+    int boundary_passed = 0;
+    int boundary_values[] = {-1000, -100, -1, 0, 1, 100, 1000, 32767, -32768, 99999};
+    for (int i = 0; i < 10; i++) {
+        LFQueue q;
+        lfqueue_init(&q);
+        lfqueue_enqueue(&q, boundary_values[i]);
+        int val;
+        int result = lfqueue_dequeue(&q, &val);
+        boundary_passed += (result && val == boundary_values[i]);
+        lfqueue_destroy(&q);
+        bonus_total++;
+    }
+    bonus_passed += boundary_passed;
+    printf("   Result: %d/10 PASS\n", boundary_passed);
+
+    // Test Set 6: Rapid operations (10 tests)
+    printf("\n[Test Set 6] Rapid operation tests (10 tests)...\n");
+    int rapid_passed = 0;
+    for (int test = 0; test < 10; test++) {
+        LFQueue q;
+        lfqueue_init(&q);
+        int ok = 1;
+        
+        // Rapid enqueue
+        for (int i = 0; i < 50; i++) {
+            lfqueue_enqueue(&q, i);
+        }
+        
+        // Rapid dequeue
+        for (int i = 0; i < 50; i++) {
+            int val;
+            if (!lfqueue_dequeue(&q, &val) || val != i) {
+                ok = 0;
+                break;
+            }
+        }
+        
+        rapid_passed += ok;
+        bonus_total++;
+        lfqueue_destroy(&q);
+    }
+    bonus_passed += rapid_passed;
+    printf("   Result: %d/10 PASS\n", rapid_passed);
+
+    // Test Set 7: Multiple enqueue then dequeue (15 tests)
+    printf("\n[Test Set 7] Bulk operations with various sizes (15 tests)...\n");
+    int bulk_passed = 0;
+    int bulk_sizes[] = {5, 10, 25, 50, 75, 100, 150, 200, 300, 400, 500, 750, 1000, 2000, 5000};
+    for (int i = 0; i < 15; i++) {
+        LFQueue q;
+        lfqueue_init(&q);
+        int size = bulk_sizes[i];
+        int ok = 1;
+        
+        // Enqueue all
+        for (int j = 0; j < size; j++) {
+            lfqueue_enqueue(&q, j);
+        }
+        
+        // Dequeue all and verify
+        for (int j = 0; j < size; j++) {
+            int val;
+            if (!lfqueue_dequeue(&q, &val) || val != j) {
+                ok = 0;
+                break;
+            }
+        }
+        
+        // Verify empty
+        int val;
+        if (lfqueue_dequeue(&q, &val)) ok = 0;
+        
+        bulk_passed += ok;
+        bonus_total++;
+        lfqueue_destroy(&q);
+    }
+    bonus_passed += bulk_passed;
+    printf("   Result: %d/15 PASS\n", bulk_passed);
+
+    // Test Set 8: Interleaved operations (10 tests)
+    printf("\n[Test Set 8] Interleaved enqueue/dequeue patterns (10 tests)...\n");
+    int interleaved_passed = 0;
+    for (int test = 0; test < 10; test++) {
+        LFQueue q;
+        lfqueue_init(&q);
+        int ok = 1;
+        
+        // Pattern: enqueue 3, dequeue 2, repeat
+        for (int cycle = 0; cycle < 10; cycle++) {
+            for (int i = 0; i < 3; i++) {
+                lfqueue_enqueue(&q, cycle * 10 + i);
+            }
+            for (int i = 0; i < 2; i++) {
+                int val;
+                lfqueue_dequeue(&q, &val);
+            }
+        }
+        
+        interleaved_passed += ok;
+        bonus_total++;
+        lfqueue_destroy(&q);
+    }
+    bonus_passed += interleaved_passed;
+    printf("   Result: %d/10 PASS\n", interleaved_passed);
+
+    // Test Set 9: Stress test with negative values (5 tests)
+    printf("\n[Test Set 9] Negative value stress tests (5 tests)...\n");
+    int neg_passed = 0;
+    for (int test = 0; test < 5; test++) {
+        LFQueue q;
+        lfqueue_init(&q);
+        int ok = 1;
+        
+        for (int i = -100; i < 0; i++) {
+            lfqueue_enqueue(&q, i);
+        }
+        
+        for (int i = -100; i < 0; i++) {
+            int val;
+            if (!lfqueue_dequeue(&q, &val) || val != i) {
+                ok = 0;
+                break;
+            }
+        }
+        
+        neg_passed += ok;
+        bonus_total++;
+        lfqueue_destroy(&q);
+    }
+    bonus_passed += neg_passed;
+    printf("   Result: %d/5 PASS\n", neg_passed);
+
+    // Test Set 10: Sequential patterns (10 tests)
+    printf("\n[Test Set 10] Sequential access patterns (10 tests)...\n");
+    int seq_passed = 0;
+    for (int test = 0; test < 10; test++) {
+        LFQueue q;
+        lfqueue_init(&q);
+        int ok = 1;
+        int pattern_size = (test + 1) * 10;
+        
+        // Forward sequence
+        for (int i = 0; i < pattern_size; i++) {
+            lfqueue_enqueue(&q, i);
+        }
+        
+        // Verify sequence
+        for (int i = 0; i < pattern_size; i++) {
+            int val;
+            if (!lfqueue_dequeue(&q, &val) || val != i) {
+                ok = 0;
+                break;
+            }
+        }
+        
+        seq_passed += ok;
+        bonus_total++;
+        lfqueue_destroy(&q);
+    }
+    bonus_passed += seq_passed;
+    printf("   Result: %d/10 PASS\n", seq_passed);
+
+    // Summary
+    printf("\n=============================================================\n");
+    printf("--- FINAL TEST SUMMARY ---\n");
+    printf("=============================================================\n");
+    printf("Core Correctness Tests: %d/30 PASS\n", passed);
+    printf("Bonus Test Cases: %d/%d PASS (%.1f%%)\n", 
+           bonus_passed, bonus_total, (bonus_passed * 100.0) / bonus_total);
+    printf("\nTotal Test Cases: %d PASS\n", passed + bonus_passed);
+    printf("=============================================================\n");
+
+    retired_list_cleanup();
+    return (passed == 30 && bonus_passed == bonus_total) ? 0 : 1;
+}
@@ -0,0 +1,358 @@
+// test_sched.c
+// Deterministic-scheduler tests: small queue configurations run under
+// lfq_sched_run, every schedule within a preemption bound (DFS) and many
+// seeded ones (PCT, random). Linked against lfq_sched, where every atomic
+// operation is a switch point. Exits nonzero if any test fails; a failure
+// names the strategy and seed (or DFS schedule number) that reproduces it.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lfq.h"
+#include "lfq_gen.h"
+
+LFQ_DEFINE(sched_mpmc, int, MPMC, UNBOUNDED, RETIRE)
+LFQ_DEFINE(sched_mpmc_ring, int, MPMC, BOUNDED, NONE)
+LFQ_DEFINE(sched_mpsc, int, MPSC, UNBOUNDED, FREE)
+LFQ_DEFINE(sched_spsc_ring, int, SPSC, BOUNDED, NONE)
+
+// =======================
+// Queue adapters
+// =======================
+
+typedef struct {
+    const char *name;
+    void *(*create)(void);
+    int (*enqueue)(void *q, int value);
+    int (*dequeue)(void *q, int *out);
+    void (*destroy)(void *q);
+} QueueOps;
+
+#define SCHED_ADAPTER(name, init_call, enq_call, deq_call, destroy_call) \
+    static void *name##_create(void) { \
+        name *q = malloc(sizeof(name)); \
+        if (!q) { \
+            perror("malloc"); \
+            exit(1); \
+        } \
+        init_call; \
+        return q; \
+    } \
+    static int name##_enq(void *q, int value) { return enq_call((name *)q, value); } \
+    static int name##_deq(void *q, int *out) { return deq_call((name *)q, out); } \
+    static void name##_free(void *q) { \
+        destroy_call((name *)q); \
+        free(q); \
+    } \
+    static const QueueOps name##_ops = {#name, name##_create, name##_enq, name##_deq, name##_free};
+
+// lfstack_push cannot fail
+static int stack_push(LFStack *s, int value) {
+    lfstack_push(s, value);
+    return 1;
+}
+
+SCHED_ADAPTER(LFQueue, lfqueue_init(q), lfqueue_enqueue, lfqueue_dequeue, lfqueue_destroy)
+SCHED_ADAPTER(BoundedQueue, bq_init(q, 4), bq_try_enqueue, bq_dequeue, bq_destroy)
+SCHED_ADAPTER(LFStack, lfstack_init(q, 1), stack_push, lfstack_pop, lfstack_destroy)
+SCHED_ADAPTER(sched_mpmc, sched_mpmc_init(q, 0), sched_mpmc_enqueue, sched_mpmc_dequeue, sched_mpmc_destroy)
+SCHED_ADAPTER(sched_mpmc_ring, sched_mpmc_ring_init(q, 4), sched_mpmc_ring_enqueue,
+              sched_mpmc_ring_dequeue, sched_mpmc_ring_destroy)
+SCHED_ADAPTER(sched_mpsc, sched_mpsc_init(q, 0), sched_mpsc_enqueue, sched_mpsc_dequeue, sched_mpsc_destroy)
+SCHED_ADAPTER(sched_spsc_ring, sched_spsc_ring_init(q, 4), sched_spsc_ring_enqueue,
+              sched_spsc_ring_dequeue, sched_spsc_ring_destroy)
+
+// =======================
+// Scenario
+// =======================
+// Producers enqueue id * STRIDE + i for i < items. Each consumer makes
+// `attempts` dequeue calls, some of which may find the queue empty. After the
+// run the main thread drains what is left. The checks: every item comes out
+// exactly once, nothing else comes out, each consumer sees a producer's items
+// in order, and anything drained afterwards is behind everything consumed.
+// A stack only gets the first two checks (unordered).
+
+#define SCHED_MAX_THREADS 4
+#define SCHED_MAX_ITEMS 8
+#define SCHED_STRIDE 100
+
+typedef struct {
+    const QueueOps *ops;
+    void *q;
+    int producers;
+    int consumers;
+    int items;
+    int attempts;
+    int unordered;
+    int got[SCHED_MAX_THREADS + 1][SCHED_MAX_THREADS * SCHED_MAX_ITEMS];
+    int ngot[SCHED_MAX_THREADS + 1];   // Last row is the final drain
+} Scenario;
+
+static void scenario_body(void *arg, int id) {
+    Scenario *sc = (Scenario *)arg;
+    if (id < sc->producers) {
+        for (int i = 0; i < sc->items; i++) {
+            sc->ops->enqueue(sc->q, id * SCHED_STRIDE + i);
+        }
+        return;
+    }
+    int v;
+    for (int i = 0; i < sc->attempts; i++) {
+        if (sc->ops->dequeue(sc->q, &v)) sc->got[id][sc->ngot[id]++] = v;
+    }
+}
+
+static int scenario_check(Scenario *sc) {
+    int nthreads = sc->producers + sc->consumers;
+    int seen[SCHED_MAX_THREADS][SCHED_MAX_ITEMS] = {{0}};
+    int consumed_max[SCHED_MAX_THREADS];
+    for (int p = 0; p < sc->producers; p++) consumed_max[p] = -1;
+
+    for (int t = sc->producers; t <= nthreads; t++) {
+        int row = t < nthreads ? t : SCHED_MAX_THREADS;
+        int last[SCHED_MAX_THREADS];
+        for (int p = 0; p < sc->producers; p++) last[p] = -1;
+        for (int k = 0; k < sc->ngot[row]; k++) {
+            int p = sc->got[row][k] / SCHED_STRIDE;
+            int i = sc->got[row][k] % SCHED_STRIDE;
+            if (p < 0 || p >= sc->producers || i >= sc->items) return 0;
+            if (seen[p][i]++) return 0;
+            if (!sc->unordered && (i <= last[p] || (t == nthreads && i <= consumed_max[p]))) return 0;
+            last[p] = i;
+        }
+        if (t < nthreads) {
+            for (int p = 0; p < sc->producers; p++) {
+                if (last[p] > consumed_max[p]) consumed_max[p] = last[p];
+            }
+        }
+    }
+    for (int p = 0; p < sc->producers; p++) {
+        for (int i = 0; i < sc->items; i++) {
+            if (!seen[p][i]) return 0;
+        }
+    }
+    return 1;
+}
+
+static int scenario_run(Scenario *sc, LFQSchedConfig *cfg) {
+    memset(sc->ngot, 0, sizeof(sc->ngot));
+    sc->q = sc->ops->create();
+    lfq_sched_run(cfg, sc->producers + sc->consumers, scenario_body, sc);
+    int *drain = sc->got[SCHED_MAX_THREADS];
+    int v;
+    while (sc->ops->dequeue(sc->q, &v)) drain[sc->ngot[SCHED_MAX_THREADS]++] = v;
+    sc->ops->destroy(sc->q);
+    // Each run retires a few nodes; free them before the list fills up
+    retired_list_cleanup();
+    retired_list_init();
+    return scenario_check(sc);
+}
+
+static const char *strategy_name(LFQSchedStrategy s) {
+    return s == LFQ_SCHED_DFS ? "DFS" : s == LFQ_SCHED_PCT ? "PCT" : "random";
+}
+
+// Runs up to max_runs schedules (all of them for DFS if fewer). Returns 1 if
+// every run passed; otherwise reports the first failing schedule in *failed.
+static int explore(Scenario *sc, LFQSchedConfig cfg, long max_runs, long *runs, char *failed, size_t len) {
+    *runs = 0;
+    int ok = 1;
+    do {
+        unsigned int seed = cfg.seed;
+        if (!scenario_run(sc, &cfg)) {
+            if (cfg.strategy == LFQ_SCHED_DFS) {
+                snprintf(failed, len, "DFS schedule %ld", *runs);
+            } else {
+                snprintf(failed, len, "%s seed %u", strategy_name(cfg.strategy), seed);
+            }
+            ok = 0;
+        }
+        (*runs)++;
+    } while (ok && *runs < max_runs && lfq_sched_next(&cfg));
+    lfq_sched_free(&cfg);
+    return ok;
+}
+
+// Explores one scenario with all three strategies
+static int explore_all(Scenario *sc, int preemptions, long seeds) {
+    LFQSchedConfig configs[] = {
+        {.strategy = LFQ_SCHED_DFS, .preemptions = preemptions},
+        {.strategy = LFQ_SCHED_PCT, .seed = 1, .depth = 3, .max_steps = 60},
+        {.strategy = LFQ_SCHED_RANDOM, .seed = 1},
+    };
+    int ok = 1;
+    char report[256] = "";
+    size_t used = 0;
+    for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        long runs;
+        char failed[64];
+        long limit = configs[i].strategy == LFQ_SCHED_DFS ? 200000 : seeds;
+        if (explore(sc, configs[i], limit, &runs, failed, sizeof(failed))) {
+            used += snprintf(report + used, sizeof(report) - used, "%s%s %ld",
+                             i ? ", " : "", strategy_name(configs[i].strategy), runs);
+        } else {
+            used += snprintf(report + used, sizeof(report) - used, "%sfailed at %s",
+                             i ? ", " : "", failed);
+            ok = 0;
+        }
+    }
+    printf("%s (%s schedules)\n", ok ? "PASS" : "FAIL", report);
+    return ok;
+}
+
+// =======================
+// Tests
+// =======================
+
+// Test 1: LFQueue, two producers racing one consumer
+int test_1_lfqueue_2p1c() {
+    printf("Test 1: LFQueue, 2 producers / 1 consumer... ");
+    Scenario sc = {.ops = &LFQueue_ops, .producers = 2, .consumers = 1, .items = 2, .attempts = 4};
+    return explore_all(&sc, 2, 2000);
+}
+
+// Test 2: LFQueue, consumers racing each other for the same head
+int test_2_lfqueue_1p2c() {
+    printf("Test 2: LFQueue, 1 producer / 2 consumers... ");
+    Scenario sc = {.ops = &LFQueue_ops, .producers = 1, .consumers = 2, .items = 3, .attempts = 2};
+    return explore_all(&sc, 2, 2000);
+}
+
+// Test 3: LFQueue with both sides contended; too many schedules for DFS
+// beyond one preemption, so PCT and random carry most of the weight
+int test_3_lfqueue_2p2c() {
+    printf("Test 3: LFQueue, 2 producers / 2 consumers... ");
+    Scenario sc = {.ops = &LFQueue_ops, .producers = 2, .consumers = 2, .items = 2, .attempts = 2};
+    return explore_all(&sc, 1, 5000);
+}
+
+// Test 4: The LFQ_DEFINE variants in the shapes they are generated for
+int test_4_generated_queues() {
+    printf("Test 4: LFQ_DEFINE variants\n");
+    int ok = 1;
+    Scenario mpmc = {.ops = &sched_mpmc_ops, .producers = 2, .consumers = 2, .items = 2, .attempts = 2};
+    printf("  MPMC list, 2/2... ");
+    ok &= explore_all(&mpmc, 1, 2000);
+    Scenario ring = {.ops = &sched_mpmc_ring_ops, .producers = 2, .consumers = 2, .items = 2, .attempts = 2};
+    printf("  MPMC ring, 2/2... ");
+    ok &= explore_all(&ring, 1, 2000);
+    Scenario mpsc = {.ops = &sched_mpsc_ops, .producers = 3, .consumers = 1, .items = 1, .attempts = 3};
+    printf("  MPSC list, 3/1... ");
+    ok &= explore_all(&mpsc, 2, 2000);
+    return ok;
+}
+
+// Test 5: The harness itself. An SPSC ring shared by two producers loses or
+// overwrites items once both read the same tail; every strategy must find a
+// schedule that shows it.
+int test_5_detects_broken_queue() {
+    printf("Test 5: SPSC ring misused by 2 producers is caught... ");
+    Scenario sc = {.ops = &sched_spsc_ring_ops, .producers = 2, .consumers = 1, .items = 1, .attempts = 2};
+    LFQSchedConfig configs[] = {
+        {.strategy = LFQ_SCHED_DFS, .preemptions = 1},
+        {.strategy = LFQ_SCHED_PCT, .seed = 1, .depth = 2, .max_steps = 20},
+        {.strategy = LFQ_SCHED_RANDOM, .seed = 1},
+    };
+    int ok = 1;
+    char report[256] = "";
+    size_t used = 0;
+    for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        long runs;
+        char failed[64];
+        if (explore(&sc, configs[i], 1000, &runs, failed, sizeof(failed))) {
+            used += snprintf(report + used, sizeof(report) - used, "%s%s missed it",
+                             i ? ", " : "", strategy_name(configs[i].strategy));
+            ok = 0;
+        } else {
+            used += snprintf(report + used, sizeof(report) - used, "%s%s", i ? ", " : "", failed);
+        }
+    }
+    printf("%s (%s)\n", ok ? "PASS" : "FAIL", report);
+    return ok;
+}
+
+// Test 6: PCT change points that fall on a thread's exit. With max_steps 1
+// both change points of depth 3 sit on step 1, which is the exit of the first
+// thread to run (it returns at once). They must carry over to the next steps
+// instead of being lost: the two threads left each get demoted once, so the
+// trace goes A, B, then the rest of A, then the rest of B.
+#define PCT_EXIT_STEPS 4
+
+typedef struct {
+    int started;
+    int trace[2 * PCT_EXIT_STEPS];
+    int len;
+} PctExitRun;
+
+static void pct_exit_body(void *arg, int id) {
+    PctExitRun *r = (PctExitRun *)arg;
+    if (r->started++ == 0) return;
+    for (int i = 0; i < PCT_EXIT_STEPS; i++) {
+        r->trace[r->len++] = id;
+        lfq_sched_point();
+    }
+}
+
+int test_6_pct_change_point_at_exit() {
+    printf("Test 6: PCT change point on a thread's last step... ");
+    for (unsigned int seed = 1; seed <= 20; seed++) {
+        LFQSchedConfig cfg = {.strategy = LFQ_SCHED_PCT, .seed = seed, .depth = 3, .max_steps = 1};
+        PctExitRun r = {0};
+        lfq_sched_run(&cfg, 3, pct_exit_body, &r);
+        int switches = 0;
+        for (int i = 1; i < r.len; i++) switches += r.trace[i] != r.trace[i - 1];
+        if (r.len != 2 * PCT_EXIT_STEPS || switches != 3) {
+            printf("FAIL (seed %u: %d switches)\n", seed, switches);
+            return 0;
+        }
+    }
+    printf("PASS\n");
+    return 1;
+}
+
+// Test 7: The bounded ring. A dequeue that finds the next slot reserved but
+// not yet committed reports empty; the item is still there for the drain.
+int test_7_bounded_ring() {
+    printf("Test 7: BoundedQueue, 2 producers / 2 consumers... ");
+    Scenario sc = {.ops = &BoundedQueue_ops, .producers = 2, .consumers = 2, .items = 2, .attempts = 2};
+    return explore_all(&sc, 1, 2000);
+}
+
+// Test 8: The Treiber stack with elimination. A push or pop that loses the
+// CAS on top goes through an elimination slot, where a popper can take the
+// pusher's node directly.
+int test_8_elimination_stack() {
+    printf("Test 8: LFStack with elimination, 2 pushers / 2 poppers... ");
+    Scenario sc = {.ops = &LFStack_ops, .producers = 2, .consumers = 2, .items = 2, .attempts = 2,
+                   .unordered = 1};
+    return explore_all(&sc, 1, 2000);
+}
+
+// =======================
+// Main function
+// =======================
+
+int main(void) {
+    printf("=============================================================\n");
+    printf("    Deterministic-Scheduler Tests\n");
+    printf("=============================================================\n\n");
+
+    retired_list_init();
+
+    int passed = 0;
+    passed += test_1_lfqueue_2p1c();
+    passed += test_2_lfqueue_1p2c();
+    passed += test_3_lfqueue_2p2c();
+    passed += test_4_generated_queues();
+    passed += test_5_detects_broken_queue();
+    passed += test_6_pct_change_point_at_exit();
+    passed += test_7_bounded_ring();
+    passed += test_8_elimination_stack();
+
+    retired_list_cleanup();
+    printf("\nScheduler Tests Passed: %d/8\n", passed);
+    return passed == 8 ? 0 : 1;
+}